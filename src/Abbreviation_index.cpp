@@ -0,0 +1,26 @@
+#include "Abbreviation_index.h"
+
+#include "Utility.h"
+
+#include <cassert>
+
+using namespace std;
+
+// One count for every pair of bytes
+const size_t abbreviation_key_count_c = 1 << 16;
+
+// The keys only cover names abbreviated to two characters
+Abbreviation_index::Abbreviation_index() : counts(abbreviation_key_count_c, 0) {
+    assert(name_abbreviation_length_c == 2);
+}
+
+// Count the name
+void Abbreviation_index::add(const string& name) {
+    ++counts[get_key(name)];
+}
+
+// Uncount the name
+void Abbreviation_index::remove(const string& name) {
+    assert(counts[get_key(name)] > 0);
+    --counts[get_key(name)];
+}
@@ -0,0 +1,50 @@
+#ifndef ABBREVIATION_INDEX_H
+#define ABBREVIATION_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/* Abbreviation_index
+ *
+ * Counts the names in use by their abbreviation, the first two characters that
+ * the views show, so whether a new name would clash with one in use can be found
+ * with a single look in a table, without making any strings. A name shorter than
+ * an abbreviation is counted as itself, so it only clashes with the same name.
+ */
+
+class Abbreviation_index {
+public:
+    Abbreviation_index();
+
+    // Count name under its abbreviation
+    void add(const std::string& name);
+
+    // Stop counting name, which must have been added
+    void remove(const std::string& name);
+
+    // Return true if a name with the same abbreviation as name is in use
+    bool is_abbreviation_in_use(const std::string& name) const
+        { return counts[get_key(name)] > 0; }
+
+    // Bytes used by the table of counts
+    std::size_t get_memory_size() const
+        { return counts.capacity() * sizeof(counts[0]); }
+
+    void swap(Abbreviation_index& other)
+        { counts.swap(other.counts); }
+
+private:
+    // The number of names in use with each abbreviation, by key
+    std::vector<int> counts;
+
+    // The key is made from the bytes of the first two characters, with a missing
+    // character counted as 0
+    static std::size_t get_key(const std::string& name) {
+        std::size_t first = name.size() > 0 ? static_cast<unsigned char>(name[0]) : 0;
+        std::size_t second = name.size() > 1 ? static_cast<unsigned char>(name[1]) : 0;
+        return (first << 8) | second;
+    }
+};
+
+#endif
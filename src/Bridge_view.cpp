@@ -69,15 +69,16 @@ void Bridge_view::draw() const {
 // Translate a point on the ocean to a location on a 19x1 grid that is the view
 // off the front of ownship
 pair<bool, Point> Bridge_view::translate_point_handler(Point point) const {
-    Compass_position position(ownship_location, point);
-
     // If the object is out of range, do not show it on the grid by setting the
-    // first element of the returned pair to false.
-    if (position.range > bridge_view_draw_dist_c ||
-            position.range < double_close_enough_c)
+    // first element of the returned pair to false. The range is checked before
+    // working out the bearing, which is only needed for objects that are shown.
+    double dist_squared = cartesian_distance_squared(ownship_location, point);
+    if (dist_squared > bridge_view_draw_dist_c * bridge_view_draw_dist_c ||
+            dist_squared < double_close_enough_c * double_close_enough_c)
         return {false, {0., 0.}};
 
     // Figure out the angle off the bow the target object is at
+    Compass_position position(ownship_location, point);
     double bow_angle = position.bearing - ownship_heading;
     // Make the resulting bow_angle between -180 and 180 degrees
     if (bow_angle > 180.)
@@ -0,0 +1,322 @@
+#include "Collision_view.h"
+
+#include "Navigation.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <numeric>
+
+using namespace std;
+
+const int collision_column_width_c = 10;
+// A ship whose box spans more than this many cells across or down is paired with
+// every ship instead of being entered in the grid
+const long long max_cell_span_c = 4;
+// The entries are put in cell order by counting when there are no more than this
+// many cells per entry
+const uint64_t dense_grid_factor_c = 4;
+
+/* Public member functions */
+
+Collision_view::Collision_view(double warning_range_, double horizon_) :
+        warning_range(warning_range_), horizon(horizon_) { }
+
+// Store the location of a ship or island
+void Collision_view::update_location(const string& name, Point location) {
+    int index = get_index(name);
+    x[index] = location.x;
+    y[index] = location.y;
+}
+
+// Store the course of a ship, only ships have one
+void Collision_view::update_course(const string& name, double course) {
+    int index = get_index(name);
+    courses[index] = course;
+    is_ship[index] = true;
+    update_velocity(index);
+}
+
+// Store the speed of a ship
+void Collision_view::update_speed(const string& name, double speed) {
+    int index = get_index(name);
+    speeds[index] = speed;
+    update_velocity(index);
+}
+
+// Move the last object into the removed object's place
+void Collision_view::update_remove(const string& name) {
+    auto index_it = index_map.find(name);
+    if (index_it == index_map.end())
+        return;
+    int index = index_it->second;
+    int last = names.size() - 1;
+    if (index != last) {
+        names[index] = move(names[last]);
+        x[index] = x[last];
+        y[index] = y[last];
+        courses[index] = courses[last];
+        speeds[index] = speeds[last];
+        x_velocities[index] = x_velocities[last];
+        y_velocities[index] = y_velocities[last];
+        is_ship[index] = is_ship[last];
+        index_map[names[index]] = index;
+    }
+    index_map.erase(index_it);
+    names.pop_back();
+    x.pop_back();
+    y.pop_back();
+    courses.pop_back();
+    speeds.pop_back();
+    x_velocities.pop_back();
+    y_velocities.pop_back();
+    is_ship.pop_back();
+}
+
+// Both lists of warnings are in name order, so the new ones are found by merging
+void Collision_view::update_time(int) {
+    vector<Warning> old_warnings;
+    swap(old_warnings, warnings);
+    screen_ships();
+    auto names_less = [](const Warning& lhs, const Warning& rhs) {
+        return tie(lhs.first_name, lhs.second_name) < tie(rhs.first_name, rhs.second_name);
+    };
+    auto old_it = old_warnings.begin();
+    for (const Warning& warning : warnings) {
+        while (old_it != old_warnings.end() && names_less(*old_it, warning))
+            ++old_it;
+        if (old_it != old_warnings.end() && !names_less(warning, *old_it))
+            continue;
+        cout << "Collision warning: " << warning.first_name << " and " <<
+                warning.second_name << " will close to " << warning.cpa_range <<
+                " nm in " << warning.cpa_time << " hr" << endl;
+    }
+}
+
+// Print the pairs in danger as a table
+void Collision_view::draw() const {
+    cout << "----- Collision Warnings -----" << endl;
+    cout << "Range " << warning_range << " nm, horizon " << horizon << " hr" << endl;
+    if (warnings.empty()) {
+        cout << "No ships in danger" << endl;
+        return;
+    }
+    cout << setw(collision_column_width_c) << "Ship" <<
+    setw(collision_column_width_c) << "Ship" <<
+    setw(collision_column_width_c) << "CPA" <<
+    setw(collision_column_width_c) << "Time" << endl;
+    for (const Warning& warning : warnings) {
+        cout << setw(collision_column_width_c) << warning.first_name <<
+        setw(collision_column_width_c) << warning.second_name <<
+        setw(collision_column_width_c) << warning.cpa_range <<
+        setw(collision_column_width_c) << warning.cpa_time << endl;
+    }
+}
+
+// Only ships are screened, islands don't move and can't collide
+int Collision_view::screen_ships() {
+    screened.clear();
+    for (int i = 0; i < static_cast<int>(names.size()); ++i) {
+        if (is_ship[i])
+            screened.push_back(i);
+    }
+    find_candidates();
+    compute_candidate_CPAs();
+
+    warnings.clear();
+    for (size_t k = 0; k < candidates.size(); ++k) {
+        if (cpa_ranges[k] >= warning_range)
+            continue;
+        const string* first_name = &names[screened[candidates[k].first]];
+        const string* second_name = &names[screened[candidates[k].second]];
+        if (*second_name < *first_name)
+            swap(first_name, second_name);
+        warnings.push_back({*first_name, *second_name,
+                cpa_ranges[k], cpa_times[k]});
+    }
+    sort(warnings.begin(), warnings.end(), [](const Warning& lhs, const Warning& rhs) {
+        return tie(lhs.first_name, lhs.second_name) < tie(rhs.first_name, rhs.second_name);
+    });
+    return warnings.size();
+}
+
+/* Private member functions */
+
+int Collision_view::get_index(const string& name) {
+    auto index_it = index_map.find(name);
+    if (index_it != index_map.end())
+        return index_it->second;
+    int index = names.size();
+    index_map.emplace(name, index);
+    names.push_back(name);
+    x.push_back(0.);
+    y.push_back(0.);
+    courses.push_back(0.);
+    speeds.push_back(0.);
+    x_velocities.push_back(0.);
+    y_velocities.push_back(0.);
+    is_ship.push_back(false);
+    return index;
+}
+
+void Collision_view::update_velocity(int index) {
+    Cartesian_vector velocity = to_Cartesian_vector(Course_speed(courses[index], speeds[index]));
+    x_velocities[index] = velocity.delta_x;
+    y_velocities[index] = velocity.delta_y;
+}
+
+// A pair whose boxes overlap shares every cell that the overlap touches, and is
+// only taken from the cell holding the overlap's low corner. The cells are about
+// the size of an average box, so most ships are entered in only a few cells.
+void Collision_view::find_candidates() {
+    candidates.clear();
+    int count = screened.size();
+    if (count < 2)
+        return;
+
+    low_x.resize(count);
+    low_y.resize(count);
+    high_x.resize(count);
+    high_y.resize(count);
+    double half_range = warning_range / 2.;
+    double extent_total = 0.;
+    for (int i = 0; i < count; ++i) {
+        int ship = screened[i];
+        double end_x = x[ship] + x_velocities[ship] * horizon;
+        double end_y = y[ship] + y_velocities[ship] * horizon;
+        low_x[i] = min(x[ship], end_x) - half_range;
+        low_y[i] = min(y[ship], end_y) - half_range;
+        high_x[i] = max(x[ship], end_x) + half_range;
+        high_y[i] = max(y[ship], end_y) + half_range;
+        extent_total += max(high_x[i] - low_x[i], high_y[i] - low_y[i]);
+    }
+    double cell_size = extent_total / count;
+    auto cell_of = [cell_size](double coordinate) {
+        return static_cast<long long>(floor(coordinate / cell_size));
+    };
+    auto boxes_overlap = [this](int i, int j) {
+        return low_x[i] <= high_x[j] && low_x[j] <= high_x[i] &&
+                low_y[i] <= high_y[j] && low_y[j] <= high_y[i];
+    };
+    // Pairs of ships that are both stopped are not screened
+    auto is_screened_pair = [this](int i, int j) {
+        return speeds[screened[i]] != 0. || speeds[screened[j]] != 0.;
+    };
+
+    is_oversized.assign(count, false);
+    oversized.clear();
+    cell_ranges.resize(count);
+    long long min_cell_x = 0, min_cell_y = 0, max_cell_x = -1, max_cell_y = -1;
+    size_t entry_count = 0;
+    for (int i = 0; i < count; ++i) {
+        Cell_range& range = cell_ranges[i];
+        range = {cell_of(low_x[i]), cell_of(low_y[i]), cell_of(high_x[i]), cell_of(high_y[i])};
+        if (range.high_x - range.low_x >= max_cell_span_c ||
+                range.high_y - range.low_y >= max_cell_span_c) {
+            is_oversized[i] = true;
+            oversized.push_back(i);
+            continue;
+        }
+        if (max_cell_x < min_cell_x) {
+            min_cell_x = range.low_x;
+            min_cell_y = range.low_y;
+            max_cell_x = range.high_x;
+            max_cell_y = range.high_y;
+        }
+        min_cell_x = min(min_cell_x, range.low_x);
+        min_cell_y = min(min_cell_y, range.low_y);
+        max_cell_x = max(max_cell_x, range.high_x);
+        max_cell_y = max(max_cell_y, range.high_y);
+        entry_count += (range.high_x - range.low_x + 1) * (range.high_y - range.low_y + 1);
+    }
+    // Number the cells of the part of the grid that holds the boxes row by row
+    uint64_t grid_height = max_cell_y - min_cell_y + 1;
+    uint64_t grid_size = (max_cell_x - min_cell_x + 1) * grid_height;
+    auto cell_key = [min_cell_x, min_cell_y, grid_height](long long cell_x, long long cell_y) {
+        return (cell_x - min_cell_x) * grid_height + (cell_y - min_cell_y);
+    };
+
+    // When the grid is not much bigger than the number of entries they are put in
+    // cell order by counting, otherwise they are sorted
+    cell_entries.resize(entry_count);
+    bool is_counted = grid_size <= dense_grid_factor_c * entry_count;
+    if (is_counted)
+        cell_starts.assign(grid_size + 1, 0);
+    size_t entry = 0;
+    for (int pass = is_counted ? 0 : 1; pass < 2; ++pass) {
+        for (int i = 0; i < count; ++i) {
+            if (is_oversized[i])
+                continue;
+            const Cell_range& range = cell_ranges[i];
+            for (long long cell_x = range.low_x; cell_x <= range.high_x; ++cell_x) {
+                for (long long cell_y = range.low_y; cell_y <= range.high_y; ++cell_y) {
+                    uint64_t key = cell_key(cell_x, cell_y);
+                    if (pass == 0)
+                        ++cell_starts[key + 1];
+                    else if (is_counted)
+                        cell_entries[cell_starts[key]++] = {key, i};
+                    else
+                        cell_entries[entry++] = {key, i};
+                }
+            }
+        }
+        // Turn the counts into the position of the first entry of each cell
+        if (pass == 0)
+            partial_sum(cell_starts.begin(), cell_starts.end(), cell_starts.begin());
+    }
+    if (!is_counted)
+        sort(cell_entries.begin(), cell_entries.end());
+
+    for (size_t begin = 0, end; begin < cell_entries.size(); begin = end) {
+        uint64_t key = cell_entries[begin].first;
+        for (end = begin + 1; end < cell_entries.size() && cell_entries[end].first == key; ++end);
+        for (size_t a = begin; a < end; ++a) {
+            int i = cell_entries[a].second;
+            for (size_t b = a + 1; b < end; ++b) {
+                int j = cell_entries[b].second;
+                if (!boxes_overlap(i, j) || !is_screened_pair(i, j))
+                    continue;
+                if (cell_key(cell_of(max(low_x[i], low_x[j])),
+                        cell_of(max(low_y[i], low_y[j]))) != key)
+                    continue;
+                candidates.emplace_back(i, j);
+            }
+        }
+    }
+
+    // Each pair of oversized ships is taken once, by the first of the two
+    for (int i : oversized) {
+        for (int j = 0; j < count; ++j) {
+            if (j == i || (is_oversized[j] && j < i))
+                continue;
+            if (boxes_overlap(i, j) && is_screened_pair(i, j))
+                candidates.emplace_back(i, j);
+        }
+    }
+}
+
+// The CPA of each pair is the closest the second ship comes to the first within
+// the horizon. The pairs are gathered into flat arrays of relative positions and
+// velocities so that their CPAs can be computed in one batch.
+void Collision_view::compute_candidate_CPAs() {
+    size_t count = candidates.size();
+    relative_x.resize(count);
+    relative_y.resize(count);
+    relative_x_velocity.resize(count);
+    relative_y_velocity.resize(count);
+    cpa_times.resize(count);
+    cpa_ranges.resize(count);
+    for (size_t k = 0; k < count; ++k) {
+        int first = screened[candidates[k].first];
+        int second = screened[candidates[k].second];
+        relative_x[k] = x[second] - x[first];
+        relative_y[k] = y[second] - y[first];
+        relative_x_velocity[k] = x_velocities[second] - x_velocities[first];
+        relative_y_velocity[k] = y_velocities[second] - y_velocities[first];
+    }
+
+    compute_CPAs(count, relative_x.data(), relative_y.data(), relative_x_velocity.data(),
+            relative_y_velocity.data(), horizon, cpa_ranges.data(), nullptr, cpa_times.data());
+}
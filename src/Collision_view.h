@@ -0,0 +1,114 @@
+#ifndef COLLISION_VIEW_H
+#define COLLISION_VIEW_H
+
+#include "View.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <utility>
+
+/* Collision_view
+ *
+ * Screens every pair of ships at the end of each tick for a closest point of
+ * approach (CPA) nearer than the warning range within the next horizon hours,
+ * assuming both ships hold their current course and speed. A warning is printed
+ * when a pair first comes into danger, and draw() lists every pair that is
+ * currently in danger. Pairs where neither ship is moving are not screened, since
+ * ships docked at the same island would otherwise always be in danger.
+ *
+ * Screening is done in two phases so that it scales to very large fleets. The
+ * broad phase covers the ocean with a grid of square cells and enters each ship
+ * in the cells touched by the box it sweeps over the horizon, grown by half the
+ * warning range on every side. Two ships can only come within the warning range
+ * if their boxes overlap, so only ships that share a cell are paired, and each
+ * pair is taken from just one of the cells it shares. Ships whose boxes would
+ * cover too many cells are paired with every ship instead. The narrow phase then
+ * computes the CPA of all of the candidate pairs together with compute_CPAs().
+ *
+ * Listens to the location, course, and speed information feeds and to the ticks.
+ */
+
+class Collision_view : public View {
+public:
+    // Warn about ships that will pass within warning_range_ nm of each other in
+    // the next horizon_ hours
+    Collision_view(double warning_range_, double horizon_);
+
+    // Store the location of a ship
+    void update_location(const std::string& name, Point location) override;
+
+    // Store the course and speed of a ship
+    void update_course(const std::string& name, double course) override;
+    void update_speed(const std::string& name, double speed) override;
+
+    // Forget a ship
+    void update_remove(const std::string& name) override;
+
+    // Screen the ships, and print a warning for each pair that is newly in danger
+    void update_time(int time) override;
+
+    // Print the pairs of ships found in danger at the last screening
+    void draw() const override;
+
+    // Find the pairs of ships that are in danger now, and return how many there are.
+    // Called by update_time().
+    int screen_ships();
+
+private:
+    // A pair of ships in danger, with the names in alphabetical order
+    struct Warning {
+        std::string first_name;
+        std::string second_name;
+        double cpa_range;
+        double cpa_time;
+    };
+
+    double warning_range;
+    double horizon;
+
+    // The ships, and islands, by index. The last one is moved into the place of
+    // one that is removed.
+    std::unordered_map<std::string, int> index_map;
+    std::vector<std::string> names;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> courses;
+    std::vector<double> speeds;
+    std::vector<double> x_velocities;
+    std::vector<double> y_velocities;
+    std::vector<char> is_ship; // islands have a location but no course
+
+    // Sorted by the names
+    std::vector<Warning> warnings;
+
+    // Work space kept between screenings so it doesn't need to be allocated again
+    std::vector<int> screened;
+    std::vector<double> low_x, low_y, high_x, high_y;
+    struct Cell_range {
+        long long low_x, low_y, high_x, high_y;
+    };
+    std::vector<Cell_range> cell_ranges;
+    std::vector<std::pair<std::uint64_t, int>> cell_entries;
+    std::vector<std::size_t> cell_starts;
+    std::vector<char> is_oversized;
+    std::vector<int> oversized;
+    std::vector<std::pair<int, int>> candidates;
+    std::vector<double> relative_x, relative_y, relative_x_velocity,
+            relative_y_velocity, cpa_times, cpa_ranges;
+
+    // Return the index of the named object, adding it if it is new
+    int get_index(const std::string& name);
+
+    // Work out the velocity of a ship from its course and speed
+    void update_velocity(int index);
+
+    // The broad phase, fills candidates with the pairs whose boxes overlap
+    void find_candidates();
+
+    // The narrow phase, computes the CPA of each candidate pair
+    void compute_candidate_CPAs();
+};
+
+#endif
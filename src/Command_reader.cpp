@@ -0,0 +1,292 @@
+#include "Command_reader.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <algorithm>
+
+#include <unistd.h>
+
+using namespace std;
+
+/* The text is parsed straight out of the buffer. Numbers are checked against the
+ * grammar an istream uses before they are converted, since strtod and strtol
+ * accept forms that an istream does not, such as "inf" and hexadecimal.
+ */
+
+const size_t command_reader_block_size_c = 64 * 1024;
+
+// cin's buffer when the program started, which reads the standard input
+static streambuf* const stdin_buffer_c = cin.rdbuf();
+
+const int max_exact_digits_c = 15;     // Digits that always fit exactly in a double
+const int max_exact_power_c = 22;      // Largest power of ten that is exact in a double
+const int max_simple_int_digits_c = 9; // Digits that always fit in an int
+
+static bool is_space(int c);
+static bool is_digit(int c);
+static bool convert_simple_double(const char* p, const char* end, double& d);
+static bool convert_simple_int(const char* p, const char* end, int& i);
+
+/* Public member functions */
+
+Command_reader::Command_reader(istream& is_) :
+        is(&is_), buffer(command_reader_block_size_c) { }
+
+// All of the text is in the buffer from the start
+Command_reader::Command_reader(const string& text) :
+        is(nullptr), buffer(text.begin(), text.end()), end(text.size()), at_eof(true) { }
+
+// Take the characters up to the next whitespace
+bool Command_reader::read_word(string& word) {
+    if (!skip_whitespace())
+        return false;
+    size_t length = 1;
+    int c;
+    while ((c = peek(length)) != EOF && !is_space(c))
+        ++length;
+    word.assign(&buffer[pos], length);
+    pos += length;
+    return true;
+}
+
+// Like an istream, fail if the number is out of range. Most numbers are converted
+// directly from the buffer, the rest are left to strtod.
+bool Command_reader::read_double(double& d) {
+    if (!skip_whitespace())
+        return false;
+    size_t length = scan_number(true);
+    const char* number = buffer.data() + pos;
+    pos += length;
+    if (!length)
+        return false;
+    if (convert_simple_double(number, number + length, d))
+        return true;
+    number_text.assign(number, length);
+    char* number_end;
+    d = strtod(number_text.c_str(), &number_end);
+    return *number_end == '\0' && !isinf(d);
+}
+
+// Like an istream, fail if the number doesn't fit in an int
+bool Command_reader::read_int(int& i) {
+    if (!skip_whitespace())
+        return false;
+    size_t length = scan_number(false);
+    const char* number = buffer.data() + pos;
+    pos += length;
+    if (!length)
+        return false;
+    if (convert_simple_int(number, number + length, i))
+        return true;
+    number_text.assign(number, length);
+    char* number_end;
+    errno = 0;
+    long l = strtol(number_text.c_str(), &number_end, 10);
+    if (*number_end != '\0' || errno == ERANGE || l < INT_MIN || l > INT_MAX)
+        return false;
+    i = static_cast<int>(l);
+    return true;
+}
+
+// Take everything up to the newline, then the newline itself
+void Command_reader::read_line(string& line) {
+    size_t length = 0;
+    int c;
+    while ((c = peek(length)) != EOF && c != '\n')
+        ++length;
+    line.assign(buffer.data() + pos, length);
+    pos += length;
+    if (c == '\n')
+        ++pos;
+}
+
+// Skip to the newline, stopping if the input ends first
+void Command_reader::skip_line() {
+    int c;
+    while ((c = peek(0)) != EOF && c != '\n')
+        ++pos;
+}
+
+// Recording begins at the next character to be read
+void Command_reader::start_recording() {
+    recording = true;
+    record_start = pos;
+    recorded_text.clear();
+}
+
+// The recorded text is whatever was saved while filling the buffer, plus what has
+// been read since from the buffer
+string Command_reader::take_recording() {
+    recording = false;
+    recorded_text.append(buffer.data() + record_start, pos - record_start);
+    string text;
+    text.swap(recorded_text);
+    return text;
+}
+
+/* Private member functions */
+
+// Skip the characters that an istream treats as whitespace
+bool Command_reader::skip_whitespace() {
+    int c;
+    while ((c = peek(0)) != EOF) {
+        if (!is_space(c))
+            return true;
+        ++pos;
+    }
+    return false;
+}
+
+// Save the recorded text that is about to be overwritten before moving the unread
+// text down, and grow the buffer if a single word fills all of it
+bool Command_reader::fill(size_t n) {
+    while (pos + n >= end) {
+        if (at_eof)
+            return false;
+        if (recording) {
+            recorded_text.append(buffer.data() + record_start, pos - record_start);
+            record_start = 0;
+        }
+        copy(buffer.begin() + pos, buffer.begin() + end, buffer.begin());
+        end -= pos;
+        pos = 0;
+        if (end == buffer.size())
+            buffer.resize(2 * buffer.size());
+        size_t count = read_input(buffer.data() + end, buffer.size() - end);
+        if (count == 0)
+            at_eof = true;
+        end += count;
+    }
+    return true;
+}
+
+// Read the standard input with a single read() when possible, which returns
+// whatever is available instead of waiting for the buffer to be full.
+size_t Command_reader::read_input(char* dest, size_t count) {
+    if (!is)
+        return 0;
+    if (is->tie())
+        is->tie()->flush();
+    if (is->rdbuf() != stdin_buffer_c)
+        return static_cast<size_t>(is->rdbuf()->sgetn(dest, count));
+    ssize_t result;
+    do {
+        result = read(STDIN_FILENO, dest, count);
+    } while (result < 0 && errno == EINTR);
+    return result > 0 ? static_cast<size_t>(result) : 0;
+}
+
+// Accept what an istream accepts: an optional sign, then digits, and for floating
+// numbers a single decimal point, and an exponent once a digit has been seen.
+size_t Command_reader::scan_number(bool floating) {
+    size_t length = 0;
+    int c = peek(0);
+    if (c == '+' || c == '-')
+        c = peek(++length);
+    bool found_digit = false;
+    bool found_point = false;
+    while (true) {
+        if (is_digit(c)) {
+            found_digit = true;
+        } else if (floating && c == '.' && !found_point) {
+            found_point = true;
+        } else if (floating && (c == 'e' || c == 'E') && found_digit) {
+            c = peek(++length);
+            if (c == '+' || c == '-')
+                ++length;
+            while (is_digit(peek(length)))
+                ++length;
+            break;
+        } else {
+            break;
+        }
+        c = peek(++length);
+    }
+    return length;
+}
+
+/* Helper functions */
+
+// The characters that are whitespace in the "C" locale
+static bool is_space(int c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static bool is_digit(int c) {
+    return c >= '0' && c <= '9';
+}
+
+// Convert a number accepted by scan_number(true) when it has few enough digits to
+// be held exactly, and a small enough power of ten that a single multiplication or
+// division by it is correctly rounded, giving the same result as strtod.
+// Return false, leaving d alone, for any other number.
+static bool convert_simple_double(const char* p, const char* end, double& d) {
+    static const double powers_of_ten[max_exact_power_c + 1] = {1e0, 1e1, 1e2, 1e3,
+            1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16,
+            1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    bool negative = false;
+    if (*p == '+' || *p == '-')
+        negative = *p++ == '-';
+
+    long long mantissa = 0;
+    int digits = 0;     // Digits in the mantissa, not counting leading zeros
+    int exponent = 0;
+    bool found_digit = false;
+    bool found_point = false;
+    for (; p != end && (is_digit(*p) || *p == '.'); ++p) {
+        if (*p == '.') {
+            found_point = true;
+            continue;
+        }
+        found_digit = true;
+        if ((mantissa || *p != '0') && ++digits > max_exact_digits_c)
+            return false;
+        mantissa = mantissa * 10 + (*p - '0');
+        if (found_point)
+            --exponent;
+    }
+    if (!found_digit)
+        return false;
+
+    if (p != end) {
+        // The exponent, which must have at least one digit
+        ++p;
+        bool negative_exponent = false;
+        if (p != end && (*p == '+' || *p == '-'))
+            negative_exponent = *p++ == '-';
+        if (p == end)
+            return false;
+        int exponent_value = 0;
+        for (; p != end; ++p) {
+            exponent_value = exponent_value * 10 + (*p - '0');
+            if (exponent_value > max_exact_power_c + max_exact_digits_c)
+                return false;
+        }
+        exponent += negative_exponent ? -exponent_value : exponent_value;
+    }
+
+    if (exponent < -max_exact_power_c || exponent > max_exact_power_c)
+        return false;
+    double value = static_cast<double>(mantissa);
+    value = exponent < 0 ? value / powers_of_ten[-exponent] : value * powers_of_ten[exponent];
+    d = negative ? -value : value;
+    return true;
+}
+
+// Convert a number accepted by scan_number(false) if it is short enough that it
+// can't overflow an int. Return false, leaving i alone, for any other number.
+static bool convert_simple_int(const char* p, const char* end, int& i) {
+    bool negative = false;
+    if (*p == '+' || *p == '-')
+        negative = *p++ == '-';
+    if (p == end || end - p > max_simple_int_digits_c)
+        return false;
+    int value = 0;
+    for (; p != end; ++p)
+        value = value * 10 + (*p - '0');
+    i = negative ? -value : value;
+    return true;
+}
@@ -0,0 +1,89 @@
+#ifndef COMMAND_READER_H
+#define COMMAND_READER_H
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <cstdio>
+
+/* Command_reader
+ * Splits the text of the user's commands into whitespace separated words and
+ * numbers. The text is read in large blocks into a buffer and parsed in place,
+ * instead of one character at a time through an istream.
+ *
+ * Words and numbers are read the same way the >> operators of an istream read
+ * them: leading whitespace, including newlines, is skipped, the same characters
+ * are accepted as part of a number, and reading stops at the same place. Commands
+ * therefore behave exactly as they did when they were read from cin.
+ *
+ * A Command_reader reads either from an istream or from a string of commands.
+ * When the istream's buffer is the original buffer of cin, the standard input is
+ * read directly. That is only safe if nothing has read cin before, which is the
+ * case in this program. Like cin, the stream tied to the istream is flushed
+ * before waiting for more input, so prompts appear before the user is asked.
+ */
+
+class Command_reader {
+public:
+    // Read commands from the stream buffer of is_
+    explicit Command_reader(std::istream& is_);
+
+    // Read the commands in text
+    explicit Command_reader(const std::string& text);
+
+    // Read the next word into word, return false if the input has ended
+    bool read_word(std::string& word);
+
+    // Read a number into d or i, return false if there isn't a valid number
+    bool read_double(double& d);
+    bool read_int(int& i);
+
+    // Read the rest of the current line into line, consuming the newline
+    void read_line(std::string& line);
+
+    // Discard the rest of the current line, but not the newline
+    void skip_line();
+
+    // Start keeping a copy of all the text that is read
+    void start_recording();
+
+    // Return the text read since start_recording() and stop recording
+    std::string take_recording();
+
+private:
+    std::istream* is;   // Null when reading from a string
+    std::vector<char> buffer;
+    size_t pos = 0;     // Next character to read in the buffer
+    size_t end = 0;     // End of the characters in the buffer
+    bool at_eof = false;
+
+    bool recording = false;
+    size_t record_start = 0;        // Start of the recorded text still in the buffer
+    std::string recorded_text;      // Recorded text no longer in the buffer
+
+    std::string number_text;        // Copy of a number being converted
+
+    // Return the character n places after the current position, or EOF if the
+    // input ends before it
+    int peek(size_t n)
+        { return pos + n < end || fill(n) ?
+                static_cast<unsigned char>(buffer[pos + n]) : EOF; }
+
+    // Skip whitespace, return false if the input ended
+    bool skip_whitespace();
+
+    // Move the unread characters to the front of the buffer and read more input
+    // until there is a character n places after the current position.
+    // Return false if the input ends first.
+    bool fill(size_t n);
+
+    // Read up to count characters from the input into dest, return the number read
+    size_t read_input(char* dest, size_t count);
+
+    // Return the length of the longest prefix of the unread text that an istream
+    // would take as a number, with a fraction and exponent if floating is true.
+    // The prefix is copied into number_text.
+    size_t scan_number(bool floating);
+};
+
+#endif
@@ -5,125 +5,215 @@
 #include "Ship_factory.h"
 #include "Ship_component.h"
 #include "Ship.h"
+#include "Ship_group.h"
+#include "Ship_selection.h"
 #include "Map_view.h"
 #include "Sailing_view.h"
+#include "Collision_view.h"
 #include "Bridge_view.h"
+#include "Journal.h"
+#include "Command_reader.h"
 
 #include <iostream>
 #include <algorithm>
+#include <functional>
 
 /* Controls the simulation by taking in user commands, executing member functions
  * based on the commands of the user, and letting those member functions handle
  * implimenting each command by controlling views, ships, and the simulation.
  *
  * There are two distinct types of commands, ship commands that start with a ship's
- * name, and general commands that do not. These commands are seperated into two
- * different maps in Controller::run(), and ship member functions start with "ship_".
+ * name, and general commands that do not. Both are listed in Command_table below,
+ * each entry with its general or ship member function, and are found with a
+ * perfect hash table built at compile time. Ship member functions start with
+ * "ship_". The first word of a command is only looked up as a ship's name if it
+ * is not a command, or if it is a command that a ship is named after, which
+ * shadowed_commands records; a ship's name takes precedence.
  */
 
 using namespace std;
 using namespace placeholders;
 
-static double get_double_from_cin();
-static int get_int_from_cin();
-static Point get_point_from_cin();
-static double get_speed_from_cin();
-static shared_ptr<Island> get_island_ptr_from_cin();
-static shared_ptr<Ship_component> get_ship_ptr_from_cin();
+static double get_double_from_input(Command_reader& input);
+static int get_int_from_input(Command_reader& input);
+static Point get_point_from_input(Command_reader& input);
+static double get_speed_from_input(Command_reader& input);
+static shared_ptr<Island> get_island_ptr_from_input(Command_reader& input);
+static shared_ptr<Ship_component> get_ship_ptr_from_input(Command_reader& input);
 
 
+/* Command_table
+ * The fixed vocabulary of commands, and the member functions that handle them.
+ * Ship commands follow a ship's name, generic commands do not. A friend of
+ * Controller so that it can name the private member functions.
+ *
+ * The commands are looked up with a perfect hash table that the compiler builds
+ * from the names, so finding a command takes one hash of the word and a single
+ * string comparison.
+ */
+struct Command_table {
+    struct Entry {
+        const char* name;
+        void (Controller::*generic_fn) ();
+        void (Controller::*ship_fn) (shared_ptr<Ship_component>);
+    };
+
+    static constexpr Entry entries[] = {
+            {"open_map_view", &Controller::open_map_view, nullptr},
+            {"open_sailing_view", &Controller::open_sailing_view, nullptr},
+            {"open_bridge_view", &Controller::open_bridge_view, nullptr},
+            {"open_collision_view", &Controller::open_collision_view, nullptr},
+            {"close_map_view", &Controller::close_map_view, nullptr},
+            {"close_sailing_view", &Controller::close_sailing_view, nullptr},
+            {"close_bridge_view", &Controller::close_bridge_view, nullptr},
+            {"close_collision_view", &Controller::close_collision_view, nullptr},
+            {"default", &Controller::map_default_cmd, nullptr},
+            {"size", &Controller::map_size_cmd, nullptr},
+            {"zoom", &Controller::map_zoom_cmd, nullptr},
+            {"pan", &Controller::map_pan_cmd, nullptr},
+            {"show", &Controller::show_cmd, nullptr},
+
+            {"status", &Controller::status_cmd, nullptr},
+            {"memory", &Controller::memory_cmd, nullptr},
+            {"go", &Controller::go_cmd, nullptr},
+            {"create", &Controller::create_cmd, nullptr},
+
+            {"create_group", &Controller::create_group_cmd, nullptr},
+            {"add_to_group", &Controller::add_to_group_cmd, nullptr},
+            {"remove_from_group", &Controller::remove_from_group_cmd, nullptr},
+            {"remove_group", &Controller::remove_group_cmd, nullptr},
+            {"formation", &Controller::formation_cmd, nullptr},
+            {"break_formation", &Controller::break_formation_cmd, nullptr},
+            {"group_threads", &Controller::group_threads_cmd, nullptr},
+            {"combat", &Controller::combat_cmd, nullptr},
+            {"update_order", &Controller::update_order_cmd, nullptr},
+            {"fuel_allocation", &Controller::fuel_allocation_cmd, nullptr},
+            {"load_ship_types", &Controller::load_ship_types_cmd, nullptr},
+
+            {"save", &Controller::save_cmd, nullptr},
+            {"load", &Controller::load_cmd, nullptr},
+            {"fork", &Controller::fork_cmd, nullptr},
+
+            {"journal", &Controller::journal_cmd, nullptr},
+            {"close_journal", &Controller::close_journal_cmd, nullptr},
+            {"replay", &Controller::replay_cmd, nullptr},
+
+            {"fleet", &Controller::fleet_cmd, nullptr},
+
+            {"course", nullptr, &Controller::ship_course_cmd},
+            {"position", nullptr, &Controller::ship_position_cmd},
+            {"destination", nullptr, &Controller::ship_dest_cmd},
+            {"load_at", nullptr, &Controller::ship_load_cmd},
+            {"unload_at", nullptr, &Controller::ship_unload_cmd},
+            {"dock_at", nullptr, &Controller::ship_dock_cmd},
+            {"attack", nullptr, &Controller::ship_attack_cmd},
+            {"refuel", nullptr, &Controller::ship_refuel_cmd},
+            {"stop", nullptr, &Controller::ship_stop_cmd},
+            {"stop_attack", nullptr, &Controller::ship_stop_attack_cmd},
+            {"start_skimming", nullptr, &Controller::ship_start_skimming_cmd}
+    };
+
+    static constexpr int size = sizeof(entries) / sizeof(entries[0]);
+};
+
+constexpr Command_table::Entry Command_table::entries[];
+
+// Number of slots in the hash table, a power of two well above the number of
+// commands so that a perfect hash is found after a few tries
+const unsigned command_slot_count_c = 256;
+
+// The hash table, slot[i] is the index of the command that hashes to i, or -1
+struct Command_slots {
+    unsigned seed;
+    signed char slot[command_slot_count_c];
+};
+
+// FNV-1a hash of the characters in [begin, end) starting from seed, with the high
+// bits mixed into the low bits that pick the slot
+constexpr unsigned command_hash(const char* begin, const char* end, unsigned seed) {
+    unsigned hash = seed;
+    for (; begin != end; ++begin) {
+        hash ^= static_cast<unsigned char>(*begin);
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    return hash % command_slot_count_c;
+}
+
+constexpr const char* string_end(const char* s) {
+    while (*s)
+        ++s;
+    return s;
+}
+
+// Try seeds until every command hashes to a different slot
+constexpr Command_slots make_command_slots() {
+    Command_slots slots {2166136261u, {}};
+    while (true) {
+        for (auto& slot : slots.slot)
+            slot = -1;
+        bool collision = false;
+        for (int i = 0; i < Command_table::size && !collision; ++i) {
+            const char* name = Command_table::entries[i].name;
+            auto& slot = slots.slot[command_hash(name, string_end(name), slots.seed)];
+            collision = slot != -1;
+            slot = static_cast<signed char>(i);
+        }
+        if (!collision)
+            return slots;
+        ++slots.seed;
+    }
+}
+
+constexpr Command_slots command_slots_c = make_command_slots();
+
+// Return the entry for the command named word, or nullptr if there is none
+static const Command_table::Entry* find_command(const string& word) {
+    int index = command_slots_c.slot[command_hash(word.data(), word.data() + word.size(),
+            command_slots_c.seed)];
+    if (index < 0 || word != Command_table::entries[index].name)
+        return nullptr;
+    return &Command_table::entries[index];
+}
+
 /* Public Function Definitions */
 
+// Start with the input from cin, and check which commands are hidden by ships
+Controller::Controller() :
+    shadowed_commands(Command_table::size), input(cin) {
+    update_shadowed_commands();
+}
+
+// Defined here where Journal is a complete type
+Controller::~Controller() { }
+
 // Take user input in a loop and call the corresponding member function to handle that
 // input.
 void Controller::run() {
-    // Initialize command maps, used to map user input to the corresponding member
-    // functions that handle that input.
-
-    // Command map for commands that start with a ship's name.
-    map<string, void (Controller::*) (shared_ptr<Ship_component>)> ship_cmd_map = {
-            {"course", &Controller::ship_course_cmd},
-            {"position", &Controller::ship_position_cmd},
-            {"destination", &Controller::ship_dest_cmd},
-            {"load_at", &Controller::ship_load_cmd},
-            {"unload_at", &Controller::ship_unload_cmd},
-            {"dock_at", &Controller::ship_dock_cmd},
-            {"attack", &Controller::ship_attack_cmd},
-            {"refuel", &Controller::ship_refuel_cmd},
-            {"stop", &Controller::ship_stop_cmd},
-            {"stop_attack", &Controller::ship_stop_attack_cmd},
-            {"start_skimming", &Controller::ship_start_skimming_cmd}
-    };
-
-    // Command map for commands that do not start with a ship's name.
-    map<string, void (Controller::*) ()> generic_cmd_map = {
-            {"open_map_view", &Controller::open_map_view},
-            {"open_sailing_view", &Controller::open_sailing_view},
-            {"open_bridge_view", &Controller::open_bridge_view},
-            {"close_map_view", &Controller::close_map_view},
-            {"close_sailing_view", &Controller::close_sailing_view},
-            {"close_bridge_view", &Controller::close_bridge_view},
-            {"default", &Controller::map_default_cmd},
-            {"size", &Controller::map_size_cmd},
-            {"zoom", &Controller::map_zoom_cmd},
-            {"pan", &Controller::map_pan_cmd},
-            {"show", &Controller::show_cmd},
-
-            {"status", &Controller::status_cmd},
-            {"go", &Controller::go_cmd},
-            {"create", &Controller::create_cmd},
-
-            {"create_group", &Controller::create_group_cmd},
-            {"add_to_group", &Controller::add_to_group_cmd},
-            {"remove_from_group", &Controller::remove_from_group_cmd},
-            {"remove_group", &Controller::remove_group_cmd}
-    };
-
     // Continue to take in user's input
     while (true) {
         try {
             cout << "\nTime " << Model::get_inst()->get_time() << ": Enter command: ";
+            // Keep the text of this command for the journal
+            if (journal)
+                input.start_recording();
             string command;
-            // Get the command name
-            cin >> command;
-            if (command == "quit") { // Handle the "quit" command separately.
+            // Get the command name, the end of the input is the same as "quit"
+            if (!input.read_word(command) || command == "quit") {
+                // Handle the "quit" command separately.
                 cout << "Done" << endl;
                 return;
-            } else if (Model::get_inst()->is_ship_present(command)) {
-                // If command is a ship's name, then this is a ship command
-
-                string &component_name = command; // Alias command to a more meaningful name
-
-                string ship_cmd;
-                cin >> ship_cmd; // Get the name of the ship command
-
-                auto itt = ship_cmd_map.find(ship_cmd);
-                if (itt == ship_cmd_map.end())
-                    throw Error("Unrecognized command!");
-
-                // Get the ship's pointer from the model.
-                auto ship_component_ptr =
-                        Model::get_inst()->get_ship_ptr(component_name);
-
-                // Call the handling ship command function.
-                (this->*itt->second)(ship_component_ptr);
-            } else {
-                // If it is not a ship command, it must be a regular command
-                auto itt = generic_cmd_map.find(command);
-                if (itt == generic_cmd_map.end())
-                    throw Error("Unrecognized command!");
-
-                // Call the handling command function.
-                (this->*itt->second)();
             }
+            int command_time = Model::get_inst()->get_time();
+            bool ship_command = execute_command(command);
+            if (journal)
+                journal_command(command, ship_command, command_time);
         } catch (Error& e) {
             // Handle errors thrown by our program by printing the error message,
             // clearing the input error flags if set, and ignoring the rest of the
             // input line. Then continue the program.
             cout << e.what() << endl;
-            cin.clear();
-            while (cin.peek() != '\n')
-                cin.get();
+            input.skip_line();
         } catch (std::exception& e) {
             // Handle errors thrown by the standard library by printing an error
             // message and exiting the program.
@@ -136,6 +226,38 @@ void Controller::run() {
 
 /* Private Helper Function Definitions */
 
+// Call the member function that handles a command whose first word has been read,
+// the member function reads the rest of the command from the input. A word is a
+// ship's name unless it is a command that no ship is named after, so a ship is
+// only looked up when the word can be a ship's name.
+bool Controller::execute_command(const string& command) {
+    const Command_table::Entry* entry = find_command(command);
+    if (!entry || shadowed_commands[entry - Command_table::entries]) {
+        auto ship_component_ptr = Model::get_inst()->find_ship_ptr(command);
+        if (ship_component_ptr) {
+            // If command is a ship's name, then this is a ship command
+            string ship_cmd;
+            input.read_word(ship_cmd); // Get the name of the ship command
+
+            const Command_table::Entry* ship_entry = find_command(ship_cmd);
+            if (!ship_entry || !ship_entry->ship_fn)
+                throw Error("Unrecognized command!");
+
+            // Call the handling ship command function.
+            (this->*ship_entry->ship_fn)(ship_component_ptr);
+            return true;
+        }
+    }
+
+    // If it is not a ship command, it must be a regular command
+    if (!entry || !entry->generic_fn)
+        throw Error("Unrecognized command!");
+
+    // Call the handling command function.
+    (this->*entry->generic_fn)();
+    return false;
+}
+
 // Create and open the map view
 void Controller::open_map_view() {
     if (map_view)
@@ -155,7 +277,7 @@ void Controller::open_sailing_view() {
 // Create and open a bridge view for a given ship. Throw an error if the ship
 // doesn't exist, the ship is a group, or if the view is already open.
 void Controller::open_bridge_view() {
-    auto ship_comp_ptr = get_ship_ptr_from_cin();
+    auto ship_comp_ptr = get_ship_ptr_from_input(input);
     if (!ship_comp_ptr)
         throw Error("Ship not found!");
     if (!dynamic_pointer_cast<Ship>(ship_comp_ptr))
@@ -168,6 +290,20 @@ void Controller::open_bridge_view() {
     open_view_helper(bridge_view_ptr);
 }
 
+// Create and open the collision view
+void Controller::open_collision_view() {
+    if (collision_view)
+        throw Error("Collision view is already open!");
+    double warning_range = get_double_from_input(input);
+    if (warning_range <= 0.)
+        throw Error("Warning range must be positive!");
+    double horizon = get_double_from_input(input);
+    if (horizon <= 0.)
+        throw Error("Warning horizon must be positive!");
+    collision_view = make_shared<Collision_view>(warning_range, horizon);
+    open_view_helper(collision_view);
+}
+
 // Close the map view.
 void Controller::close_map_view() {
     if_map_view_closed_error();
@@ -183,10 +319,18 @@ void Controller::close_sailing_view() {
     sailing_view = nullptr;
 }
 
+// Close the collision view.
+void Controller::close_collision_view() {
+    if (!collision_view)
+        throw Error("Collision view is not open!");
+    close_view_helper(collision_view);
+    collision_view = nullptr;
+}
+
 // Close the bridge view for a given ship.
 void Controller::close_bridge_view() {
     string ship_name;
-    cin >> ship_name;
+    input.read_word(ship_name);
     auto bridge_view_itt = bridge_view_map.find(ship_name);
     if (bridge_view_itt == bridge_view_map.end())
         throw Error("Bridge view for that ship is not open!");
@@ -204,27 +348,29 @@ void Controller::map_default_cmd() {
 // Set the map view's size
 void Controller::map_size_cmd() {
     if_map_view_closed_error();
-    int size = get_int_from_cin();
+    int size = get_int_from_input(input);
     map_view->set_size(size);
 }
 
 // Set the map view's zoom
 void Controller::map_zoom_cmd() {
     if_map_view_closed_error();
-    double scale = get_double_from_cin();
+    double scale = get_double_from_input(input);
     map_view->set_scale(scale);
 }
 
 // Set the map view's origin
 void Controller::map_pan_cmd() {
     if_map_view_closed_error();
-    double x = get_double_from_cin();
-    double y = get_double_from_cin();
+    double x = get_double_from_input(input);
+    double y = get_double_from_input(input);
     map_view->set_origin({x, y});
 }
 
-// Show all views in the order in which they were opened.
+// Show all views in the order in which they were opened, once they have been
+// sent any broadcasts that are due.
 void Controller::show_cmd() {
+    Model::get_inst()->send_scheduled_broadcasts();
     for_each(all_views.begin(), all_views.end(),
             mem_fn(&View::draw));
 }
@@ -234,6 +380,11 @@ void Controller::status_cmd() {
     Model::get_inst()->describe();
 }
 
+// Describe the memory used by the simulation
+void Controller::memory_cmd() {
+    Model::get_inst()->describe_memory();
+}
+
 // Simulate a single timestep in the simulation.
 void Controller::go_cmd() {
     Model::get_inst()->update();
@@ -242,7 +393,7 @@ void Controller::go_cmd() {
 // Create a new ship.
 void Controller::create_cmd() {
     string ship_name;
-    cin >> ship_name;
+    input.read_word(ship_name);
 
     // If the name is too short for the views to abbreviate correctly
     if (ship_name.length() < name_abbreviation_length_c)
@@ -254,12 +405,13 @@ void Controller::create_cmd() {
         throw Error("Name is invalid!");
 
     string ship_type;
-    cin >> ship_type;
+    input.read_word(ship_type);
 
-    Point point = get_point_from_cin();
+    Point point = get_point_from_input(input);
 
     shared_ptr<Ship_component> ship = create_ship(ship_name, ship_type, point);
     Model::get_inst()->add_ship(ship);
+    update_shadowed_commands();
 }
 
 // Create a group and add it to the model. Group names are less restrictive than
@@ -268,34 +420,37 @@ void Controller::create_cmd() {
 // use it.
 void Controller::create_group_cmd() {
     string group_name;
-    cin >> group_name;
+    input.read_word(group_name);
     if(Model::get_inst()->is_name_in_use(group_name))
         throw Error("Name is invalid!");
 
     auto group_ptr = create_group(group_name);
     Model::get_inst()->add_ship(group_ptr);
+    update_shadowed_commands();
 }
 
 // Add a child to a group.
 void Controller::add_to_group_cmd() {
-    shared_ptr<Ship_component> group_ptr = get_ship_ptr_from_cin();
-    shared_ptr<Ship_component> child_ptr = get_ship_ptr_from_cin();
+    shared_ptr<Ship_component> group_ptr = get_ship_ptr_from_input(input);
+    shared_ptr<Ship_component> child_ptr = get_ship_ptr_from_input(input);
     group_ptr->add_child(child_ptr);
 }
 
 // Remove a child from a group
 void Controller::remove_from_group_cmd() {
-    shared_ptr<Ship_component> group_ptr = get_ship_ptr_from_cin();
+    shared_ptr<Ship_component> group_ptr = get_ship_ptr_from_input(input);
     string child_name;
-    cin >> child_name;
+    input.read_word(child_name);
     shared_ptr<Ship_component> child_ptr = group_ptr->get_child(child_name);
+    if (!child_ptr)
+        throw Error("No child with that name!");
     group_ptr->remove_child(child_ptr);
 }
 
 // Remove a group from the simulation by clearing it, then removing the group
 // from the parent group if necessary.
 void Controller::remove_group_cmd() {
-    shared_ptr<Ship_component> group_ptr = get_ship_ptr_from_cin();
+    shared_ptr<Ship_component> group_ptr = get_ship_ptr_from_input(input);
 
     // Will throw an error if it is not a group
     group_ptr->remove_all_children();
@@ -307,57 +462,274 @@ void Controller::remove_group_cmd() {
 
     // Remove group
     Model::get_inst()->remove_ship(group_ptr);
+    Model::get_inst()->notify_gone(group_ptr->get_name());
+}
+
+// Set the leader of the group's formation
+void Controller::formation_cmd() {
+    auto group_ptr = dynamic_pointer_cast<Ship_group>(get_ship_ptr_from_input(input));
+    if (!group_ptr)
+        throw Error("Is not a group!");
+    group_ptr->set_formation_leader(get_ship_ptr_from_input(input));
+}
+
+// Clear the leader of the group's formation
+void Controller::break_formation_cmd() {
+    auto group_ptr = dynamic_pointer_cast<Ship_group>(get_ship_ptr_from_input(input));
+    if (!group_ptr)
+        throw Error("Is not a group!");
+    group_ptr->set_formation_leader(nullptr);
 }
 
+// Set the number of threads that command groups
+void Controller::group_threads_cmd() {
+    int thread_count = get_int_from_input(input);
+    if (thread_count <= 0)
+        throw Error("Number of threads must be positive!");
+    Ship_group::set_command_threads(thread_count);
+}
+
+// Choose whether hits land when they are fired or together at the end of each update
+void Controller::combat_cmd() {
+    string mode;
+    input.read_word(mode);
+    if (mode == "immediate")
+        Model::get_inst()->set_combat_batched(false);
+    else if (mode == "batched")
+        Model::get_inst()->set_combat_batched(true);
+    else
+        throw Error("Unrecognized combat mode!");
+}
+
+// Choose whether objects are updated in name order or a type at a time
+void Controller::update_order_cmd() {
+    string order;
+    input.read_word(order);
+    if (order == "name")
+        Model::get_inst()->set_update_by_type(false);
+    else if (order == "type")
+        Model::get_inst()->set_update_by_type(true);
+    else
+        throw Error("Unrecognized update order!");
+}
+
+// Choose how islands share out the fuel asked for during an update
+void Controller::fuel_allocation_cmd() {
+    string mode;
+    input.read_word(mode);
+    if (mode == "immediate")
+        Model::get_inst()->set_fuel_allocation(Model::Fuel_allocation_t::immediate);
+    else if (mode == "fifo")
+        Model::get_inst()->set_fuel_allocation(Model::Fuel_allocation_t::fifo);
+    else if (mode == "pro_rata")
+        Model::get_inst()->set_fuel_allocation(Model::Fuel_allocation_t::pro_rata);
+    else
+        throw Error("Unrecognized fuel allocation!");
+}
+
+// Define ship types from a file
+void Controller::load_ship_types_cmd() {
+    string file_name;
+    input.read_word(file_name);
+    load_ship_types(file_name);
+}
+
+// Save the state of the simulation to a snapshot file
+void Controller::save_cmd() {
+    string file_name;
+    input.read_word(file_name);
+    Model::get_inst()->save_snapshot(file_name);
+}
+
+// Load the state of the simulation from a snapshot file
+void Controller::load_cmd() {
+    string file_name;
+    input.read_word(file_name);
+    Model::get_inst()->load_snapshot(file_name);
+    update_shadowed_commands();
+}
+
+// Run the rest of the line as a what-if branch. The commands are read before the
+// world is forked so that they are consumed from the input whatever happens in the
+// branch.
+void Controller::fork_cmd() {
+    int ticks = get_int_from_input(input);
+    if (ticks < 0)
+        throw Error("Negative number of ticks entered!");
+    string branch_commands;
+    input.read_line(branch_commands);
+    replace(branch_commands.begin(), branch_commands.end(), ';', '\n');
+
+    Model::get_inst()->run_branch(ticks,
+            bind(&Controller::run_commands, this, cref(branch_commands), false));
+}
+
+// Start a journal, replacing any journal that is already open
+void Controller::journal_cmd() {
+    string file_name;
+    input.read_word(file_name);
+    int snapshot_interval = get_int_from_input(input);
+    if (snapshot_interval <= 0)
+        throw Error("Snapshot interval must be positive!");
+
+    journal.reset();
+    journal.reset(new Journal(file_name, snapshot_interval));
+}
+
+// Close the journal
+void Controller::close_journal_cmd() {
+    if (!journal)
+        throw Error("No journal is open!");
+    journal.reset();
+}
+
+// Load the snapshot, then run the commands with all of their output discarded.
+// cout is restored even if a command fails.
+void Controller::replay_cmd() {
+    string journal_file;
+    input.read_word(journal_file);
+    int time = get_int_from_input(input);
+    Journal_replay replay = find_replay(journal_file, time);
+    Model::get_inst()->load_snapshot(replay.snapshot_file);
+    update_shadowed_commands();
+
+    string replay_commands;
+    for (auto& command_text : replay.commands)
+        replay_commands.append(command_text).append(1, '\n');
+    Null_buffer null_buffer;
+    streambuf* output_buffer = cout.rdbuf(&null_buffer);
+    try {
+        run_commands(replay_commands, true);
+    } catch (Error&) {
+        cout.rdbuf(output_buffer);
+        throw;
+    }
+    cout.rdbuf(output_buffer);
+    cout << "Replayed " << replay.commands.size() << " commands to time " <<
+            Model::get_inst()->get_time() << endl;
+}
+
+// Read the selectors up to the ship command, pick out the ships in one pass over
+// the Model's ships or the group's members, then let the ship command read its
+// arguments and give the order to all of them through a Ship_selection.
+void Controller::fleet_cmd() {
+    vector<function<bool (const Ship&)>> predicates;
+    shared_ptr<Ship_group> group_ptr;
+    bool selected_all = false;
+    const Command_table::Entry* entry = nullptr;
+    while (!entry) {
+        string word;
+        input.read_word(word);
+        if (word == "all") {
+            selected_all = true;
+        } else if (word == "type") {
+            string type;
+            input.read_word(type);
+            predicates.push_back([type](const Ship& ship) {
+                return type == ship.get_type_name();
+            });
+        } else if (word == "region") {
+            Point corner1 = get_point_from_input(input);
+            Point corner2 = get_point_from_input(input);
+            Point low {min(corner1.x, corner2.x), min(corner1.y, corner2.y)};
+            Point high {max(corner1.x, corner2.x), max(corner1.y, corner2.y)};
+            predicates.push_back([low, high](const Ship& ship) {
+                Point location = ship.get_location();
+                return location.x >= low.x && location.x <= high.x &&
+                        location.y >= low.y && location.y <= high.y;
+            });
+        } else if (word == "fuel_below") {
+            double fuel = get_double_from_input(input);
+            predicates.push_back([fuel](const Ship& ship) {
+                return ship.get_fuel() < fuel;
+            });
+        } else if (word == "group") {
+            if (group_ptr)
+                throw Error("Only one group can be selected!");
+            group_ptr = dynamic_pointer_cast<Ship_group>(get_ship_ptr_from_input(input));
+            if (!group_ptr)
+                throw Error("Is not a group!");
+        } else {
+            entry = find_command(word);
+            if (!entry || !entry->ship_fn)
+                throw Error("Unrecognized command!");
+        }
+    }
+    if (!selected_all && predicates.empty() && !group_ptr)
+        throw Error("No fleet selection given!");
+
+    // Only individual ships are selected, never groups
+    auto is_selected = [&predicates](const shared_ptr<Ship_component>& ship_comp_ptr) {
+        const Ship* ship_ptr = dynamic_cast<const Ship*>(ship_comp_ptr.get());
+        return ship_ptr && all_of(predicates.begin(), predicates.end(),
+                [ship_ptr](const function<bool (const Ship&)>& pred) {
+                    return pred(*ship_ptr);
+                });
+    };
+    vector<shared_ptr<Ship_component>> ships;
+    if (group_ptr) {
+        for (auto& ship_ptr : group_ptr->get_member_ships()) {
+            if (is_selected(ship_ptr))
+                ships.push_back(ship_ptr);
+        }
+        sort(ships.begin(), ships.end(), NameComp());
+    } else {
+        ships = Model::get_inst()->get_vector_of_ships_if(is_selected);
+    }
+    if (ships.empty())
+        throw Error("No ships selected!");
+
+    (this->*entry->ship_fn)(make_shared<Ship_selection>(move(ships)));
+}
 
 // Set the course and speed of a ship.
 void Controller::ship_course_cmd(shared_ptr<Ship_component> ship) {
-    double heading = get_double_from_cin();
+    double heading = get_double_from_input(input);
 
     // If the entered heading is not valid heading according to
     // nautical navigation conventions.
     if (heading < 0. || heading >= 360.)
         throw Error("Invalid heading entered!");
 
-    double speed = get_speed_from_cin();
+    double speed = get_speed_from_input(input);
     ship->set_course_and_speed(heading, speed);
 }
 
 // Set the destination position and speed of a ship.
 void Controller::ship_position_cmd(shared_ptr<Ship_component> ship) {
-    Point position = get_point_from_cin();
-    double speed = get_speed_from_cin();
+    Point position = get_point_from_input(input);
+    double speed = get_speed_from_input(input);
     ship->set_destination_position_and_speed(position, speed);
 }
 
 // Set the destination island and speed of a ship.
 void Controller::ship_dest_cmd(shared_ptr<Ship_component> ship) {
-    shared_ptr<Island> island = get_island_ptr_from_cin();
-    double speed = get_speed_from_cin();
+    shared_ptr<Island> island = get_island_ptr_from_input(input);
+    double speed = get_speed_from_input(input);
     ship->set_destination_island_and_speed(island, speed);
 }
 
 // Set the loading location of a ship.
 void Controller::ship_load_cmd(shared_ptr<Ship_component> ship) {
-    shared_ptr<Island> island = get_island_ptr_from_cin();
+    shared_ptr<Island> island = get_island_ptr_from_input(input);
     ship->set_load_destination(island);
 }
 
 // Set the unloading location of a ship.
 void Controller::ship_unload_cmd(shared_ptr<Ship_component> ship) {
-    shared_ptr<Island> island = get_island_ptr_from_cin();
+    shared_ptr<Island> island = get_island_ptr_from_input(input);
     ship->set_unload_destination(island);
 }
 
 // Tell the ship to dock at an island.
 void Controller::ship_dock_cmd(shared_ptr<Ship_component> ship) {
-    shared_ptr<Island> island = get_island_ptr_from_cin();
+    shared_ptr<Island> island = get_island_ptr_from_input(input);
     ship->dock(island);
 }
 
 // Tell the ship to attack another ship
 void Controller::ship_attack_cmd(shared_ptr<Ship_component> ship) {
-    auto target_ptr = get_ship_ptr_from_cin();
+    auto target_ptr = get_ship_ptr_from_input(input);
     ship->attack(target_ptr);
 }
 
@@ -378,12 +750,65 @@ void Controller::ship_stop_attack_cmd(shared_ptr<Ship_component> ship) {
 
 // Tell ship to skim an oil spill
 void Controller::ship_start_skimming_cmd(std::shared_ptr<Ship_component> ship) {
-    Point spill_loc = get_point_from_cin();
-    int size = get_int_from_cin();
+    Point spill_loc = get_point_from_input(input);
+    int size = get_int_from_input(input);
     ship->start_skimming(spill_loc, size);
 }
 
 /******* Helper member functions *********/
+// Ship commands and the generic commands that change the simulation are recorded
+// with the text read for them. Loading a new world is recorded as a snapshot
+// of the result, so the journal doesn't depend on other files staying the same.
+void Controller::journal_command(const string& command, bool ship_command, int command_time) {
+    if (command == "load" || command == "replay" || command == "load_ship_types") {
+        journal->record_snapshot();
+        return;
+    }
+    if (ship_command || command == "go" || command == "create" ||
+            command == "create_group" || command == "add_to_group" ||
+            command == "remove_from_group" || command == "remove_group" ||
+            command == "formation" || command == "break_formation" ||
+            command == "fleet" || command == "combat" ||
+            command == "update_order" || command == "fuel_allocation") {
+        string command_text = input.take_recording();
+        // Arguments may have been spread over several lines
+        replace(command_text.begin(), command_text.end(), '\n', ' ');
+        command_text.erase(0, command_text.find_first_not_of(" \t"));
+        journal->record_command(command_time, command_text);
+    }
+    journal->snapshot_if_due();
+}
+
+// A stale flag only costs a lookup, since a command whose ship is gone is still
+// found, so the flags only need updating when ships are added.
+void Controller::update_shadowed_commands() {
+    for (int i = 0; i < Command_table::size; ++i)
+        shadowed_commands[i] = Model::get_inst()->is_ship_present(Command_table::entries[i].name);
+}
+
+// Swap in a reader for the text, and put the normal input back when done
+void Controller::run_commands(const string& text, bool throw_errors) {
+    Command_reader saved_input(move(input));
+    input = Command_reader(text);
+    try {
+        string command;
+        while (input.read_word(command)) {
+            try {
+                execute_command(command);
+            } catch (Error& e) {
+                if (throw_errors)
+                    throw;
+                cout << e.what() << endl;
+                input.skip_line();
+            }
+        }
+    } catch (...) {
+        input = move(saved_input);
+        throw;
+    }
+    input = move(saved_input);
+}
+
 // Throw an error if the map view is not open.
 void Controller::if_map_view_closed_error() const {
     if (!map_view)
@@ -404,47 +829,47 @@ void Controller::close_view_helper(std::shared_ptr<View> view) {
 
 /* General helper functions */
 // Get a double from the user, throw an error if the input failed.
-static double get_double_from_cin() {
+static double get_double_from_input(Command_reader& input) {
     double d;
-    if (cin >> d)
+    if (input.read_double(d))
         return d;
     else
         throw Error("Expected a double!");
 }
 
 // Get an integer from the user, throw an error if the input failed.
-static int get_int_from_cin() {
+static int get_int_from_input(Command_reader& input) {
     int i;
-    if (cin >> i)
+    if (input.read_int(i))
         return i;
     else
         throw Error("Expected an integer!");
 }
 
 // Get a point from the user, throws an error if either inputs fail.
-static Point get_point_from_cin() {
-    double x = get_double_from_cin();
-    double y = get_double_from_cin();
+static Point get_point_from_input(Command_reader& input) {
+    double x = get_double_from_input(input);
+    double y = get_double_from_input(input);
     return {x, y};
 }
 
-// Gets a speed from cin. Throws an error if the speed is negative.
-static double get_speed_from_cin() {
-    double speed = get_double_from_cin();
+// Gets a speed from the user. Throws an error if the speed is negative.
+static double get_speed_from_input(Command_reader& input) {
+    double speed = get_double_from_input(input);
     if (speed < 0.)
         throw Error("Negative speed entered!");
     return speed;
 }
 
 // Gets an island pointer from the model based on the island's name the user enters.
-static shared_ptr<Island> get_island_ptr_from_cin() {
+static shared_ptr<Island> get_island_ptr_from_input(Command_reader& input) {
     string island_name;
-    cin >> island_name;
+    input.read_word(island_name);
     return Model::get_inst()->get_island_ptr(island_name);
 }
 
-static shared_ptr<Ship_component> get_ship_ptr_from_cin() {
+static shared_ptr<Ship_component> get_ship_ptr_from_input(Command_reader& input) {
     string ship_name;
-    cin >> ship_name;
+    input.read_word(ship_name);
     return Model::get_inst()->get_ship_ptr(ship_name);
 }
\ No newline at end of file
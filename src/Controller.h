@@ -1,16 +1,21 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include "Command_reader.h"
+
 #include <map>
 #include <string>
 #include <memory>
 #include <list>
+#include <vector>
 
 class View;
 class Map_view;
 class Sailing_view;
+class Collision_view;
 class Bridge_view;
 class Ship_component;
+class Journal;
 
 /* Controller
  * This class is responsible for controlling the Model and View according to
@@ -23,16 +28,21 @@ class Ship_component;
 
 class Controller {
 public:
+    // Set up the tables of commands
+    Controller();
+    ~Controller();
+
     // Run the program by accepting user commands, creating and controlling
     // views and ships as requested by the user
     void run();
 
 private:
-    // View containers. map_view and sailing_view are null when they are not in use,
-    // and bridge_view_map contains a map of all bridge views, with the keys being
-    // the corresponding ship's name.
+    // View containers. map_view, sailing_view, and collision_view are null when
+    // they are not in use, and bridge_view_map contains a map of all bridge views,
+    // with the keys being the corresponding ship's name.
     std::shared_ptr<Map_view> map_view;
     std::shared_ptr<Sailing_view> sailing_view;
+    std::shared_ptr<Collision_view> collision_view;
     std::map<std::string, std::shared_ptr<Bridge_view>> bridge_view_map;
 
     // all_views contains a list of all views open so far, in the order in which
@@ -40,6 +50,19 @@ private:
     // the 'show' command is entered.
     std::list<std::shared_ptr<View>> all_views;
 
+    // The commands and their member functions are in Command_table, see Controller.cpp
+    friend struct Command_table;
+
+    // True for each command in Command_table that is also the name of a ship.
+    // A ship's name takes precedence over a command with the same name.
+    std::vector<bool> shadowed_commands;
+
+    // Where the commands are read from, normally cin
+    Command_reader input;
+
+    // The open journal, null when no journal is open
+    std::unique_ptr<Journal> journal;
+
     /******** Helper commands called in run() ********/
     // There is also a "quit" command that is handled by run(). It quits the program.
 
@@ -57,6 +80,12 @@ private:
     // exist or if that ship's bridge view is already open.
     void open_bridge_view();
 
+    // "open_collision_view <range> <horizon>": Opens a view that warns about ships
+    // that will pass within <range> nm of each other in the next <horizon> hours.
+    // Throws an error if the view is already open, or if <range> or <horizon> is
+    // not positive.
+    void open_collision_view();
+
     // "close_map_view": Closes the map view. Throws an error of the map view was not open.
     void close_map_view();
 
@@ -64,6 +93,10 @@ private:
     // an error if the view was not open.
     void close_sailing_view();
 
+    // "close_collision_view": Closes the collision view. Throws an error if the
+    // view was not open.
+    void close_collision_view();
+
     // "close_bridge_view <ship_name>": Closes the bridge view of <ship_name>.
     // Throws an error if that bridge view was not open.
     void close_bridge_view();
@@ -92,6 +125,10 @@ private:
     // "status": Have all islands and ships describe themselves.
     void status_cmd();
 
+    // "memory": Output the memory used by the objects of each type and the
+    // tables they share
+    void memory_cmd();
+
     // "go": Simulate a single tick of the simulation.
     void go_cmd();
 
@@ -113,6 +150,82 @@ private:
     // "remove_group <group_name>": Remove a group from the simulation
     void remove_group_cmd();
 
+    // "formation <group_name> <leader_name>": Make the group sail in formation with
+    // <leader_name>, which must be one of its individual ships. "course" and
+    // "position" commands to the group then move it as a unit at the speed of its
+    // slowest ship, with each ship keeping its offset from the leader.
+    void formation_cmd();
+
+    // "break_formation <group_name>": Give the group's ships their orders
+    // separately again.
+    void break_formation_cmd();
+
+    // "group_threads <count>": Give commands to the ships of large groups using
+    // <count> threads. The output is the same as with one thread, which is the
+    // default. Throws an error if <count> is not positive.
+    void group_threads_cmd();
+
+    // "combat <immediate|batched>": With immediate combat, the default, a warship's
+    // hit lands when it fires. With batched combat, the hits fired during an update
+    // are all resolved at its end, see Warship.h.
+    void combat_cmd();
+
+    // "update_order <name|type>": Update the objects in name order, the default,
+    // or the islands and then each type of ship in turn, which is faster for large
+    // fleets but changes the order of the output and of interactions between
+    // objects during an update, see Model.h.
+    void update_order_cmd();
+
+    // "fuel_allocation <immediate|fifo|pro_rata>": With immediate allocation, the
+    // default, an island provides fuel as soon as a ship asks for it. Otherwise the
+    // requests of an update are queued and shared out together at its end, in
+    // order of how long each ship has been waiting or in proportion to the amounts
+    // asked for. See Island.h.
+    void fuel_allocation_cmd();
+
+    // "load_ship_types <file_name>": Define the ship types in a file, which can
+    // then be given to "create". See Ship_parameters.h for the file format.
+    void load_ship_types_cmd();
+
+    // "save <file_name>": Save the state of the simulation to a snapshot file.
+    void save_cmd();
+
+    // "load <file_name>": Replace the state of the simulation with the contents
+    // of a snapshot file written by "save".
+    void load_cmd();
+
+    // "fork <ticks> [<command>; <command>...]": Ask "what if" without changing the
+    // simulation. The commands on the rest of the line are run in a copy of the world,
+    // which is then run ahead <ticks> ticks, describes itself, and is thrown away.
+    // Errors in the branch commands are reported in the branch.
+    void fork_cmd();
+
+    // "journal <file_name> <snapshot_interval>": Record every command that changes
+    // the simulation in a journal, with a snapshot every <snapshot_interval> ticks.
+    // Replaces any journal that is already open. See Journal.h for the format.
+    void journal_cmd();
+
+    // "close_journal": Stop recording commands. Throws an error if no journal is open.
+    void close_journal_cmd();
+
+    // "replay <journal_file> <time>": Reproduce the simulation at the start of <time>
+    // from a journal by loading the last snapshot before it and running the commands
+    // entered since, with their output discarded.
+    void replay_cmd();
+
+    // "fleet <selection> <ship_command> <arguments>": Give a ship command to every
+    // individual ship in the selection at once. The arguments are read once, and
+    // any ship that can't carry out the command reports its error without stopping
+    // the rest. The selection is one or more of the following, and a ship must
+    // match all of them:
+    //   all                        every ship
+    //   type <ship_type>           ships of that type
+    //   region <x1> <y1> <x2> <y2> ships within that rectangle, edges included
+    //   fuel_below <tons>          ships with less fuel than that
+    //   group <group_name>         ships in that group or its subgroups
+    // Throws an error if nothing is selected.
+    void fleet_cmd();
+
     // "<ship_name> course <heading> <speed>": Set the ship's heading and speed.
     void ship_course_cmd(std::shared_ptr<Ship_component> ship);
 
@@ -147,10 +260,30 @@ private:
     void ship_stop_attack_cmd(std::shared_ptr<Ship_component> ship);
 
     // "<ship_name> start_skimming <x> <y> <size>": Tells a ship to clean up an oil spill
-    // at (<x>, <y>) with a size of <size>
+    // at (<x>, <y>) with a size of <size>. The skimmers of a group share the spill,
+    // each skimming a strip of it.
     void ship_start_skimming_cmd(std::shared_ptr<Ship_component> ship);
 
     /******* Helper functions ********/
+    // Run the command whose first word is command, reading the rest from input.
+    // Return true if it was a ship command.
+    // May throw Error("Unrecognized command!") or any error from the command.
+    bool execute_command(const std::string& command);
+
+    // Note which commands are hidden by ships with the same name, called whenever
+    // ships are added
+    void update_shadowed_commands();
+
+    // Record a command entered at command_time that ran successfully in the journal,
+    // along with any snapshot that is due. Commands that only affect the views or
+    // don't change anything are not recorded.
+    void journal_command(const std::string& command, bool ship_command, int command_time);
+
+    // Run the commands in text, reading their arguments from text. If a command
+    // fails, throw its error if throw_errors is true, otherwise print the error and
+    // go on with the next line.
+    void run_commands(const std::string& text, bool throw_errors);
+
     // Throw an error if the map view is closed
     void if_map_view_closed_error() const;
 
@@ -1,6 +1,7 @@
 #include "Cruise_ship.h"
 #include "Model.h"
 #include "Island.h"
+#include "Snapshot.h"
 
 #include <limits>
 #include <algorithm>
@@ -9,18 +10,12 @@
 
 using namespace std;
 
-const double cruise_ship_fuel_capacity_c = 500.;
-const double cruise_ship_maximum_speed_c = 15.;
-const double cruise_ship_fuel_consumption_c = 2;
-const int cruise_ship_resistance_c = 0;
-
 /* Public Function Definitions */
 
 // Constructor for the cruise ship
-Cruise_ship::Cruise_ship(const std::string &name_, Point position_) :
-        Ship(name_, position_, cruise_ship_fuel_capacity_c,
-                cruise_ship_maximum_speed_c, cruise_ship_fuel_consumption_c,
-                cruise_ship_resistance_c),
+Cruise_ship::Cruise_ship(const std::string &name_, Point position_,
+        const Ship_parameters* parameters_) :
+        Ship(name_, position_, parameters_),
         cruise_state(CruiseState_t::not_cruising), cruise_speed(0.) { }
 
 // Updates the cruise ship according the project spec.
@@ -64,7 +59,7 @@ void Cruise_ship::update() {
 
 // Describe the cruse ship, and whether we're on a cruise or not.
 void Cruise_ship::describe() const {
-    cout << "\nCruise_ship ";
+    cout << "\n" << get_type_name() << " ";
     Ship::describe();
     switch (cruise_state) {
     case CruiseState_t::not_cruising:
@@ -124,6 +119,30 @@ void Cruise_ship::set_course_and_speed(double course, double speed) {
     Ship::set_course_and_speed(course, speed);
 }
 
+// Save the cruise state, including the islands still to visit
+void Cruise_ship::save_state(Snapshot_writer& writer) const {
+    Ship::save_state(writer);
+    writer.write_int(static_cast<int>(cruise_state));
+    writer.write_island(origin_island);
+    writer.write_double(cruise_speed);
+    writer.write_island(next_destination);
+    writer.write_int(static_cast<int>(islands_to_visit.size()));
+    for (auto& island_ptr : islands_to_visit)
+        writer.write_island(island_ptr);
+}
+
+// Restore the cruise state
+void Cruise_ship::restore_state(Snapshot_reader& reader) {
+    Ship::restore_state(reader);
+    cruise_state = static_cast<CruiseState_t>(reader.read_int());
+    origin_island = reader.read_island();
+    cruise_speed = reader.read_double();
+    next_destination = reader.read_island();
+    islands_to_visit.clear();
+    for (int i = reader.read_int(); i > 0; --i)
+        islands_to_visit.insert(islands_to_visit.end(), reader.read_island());
+}
+
 /* Private helper functions */
 
 // Start cruising towards next_island
@@ -23,7 +23,8 @@
 class Cruise_ship : public Ship {
 public:
     // Construct a cruise ship
-    Cruise_ship(const std::string &name_, Point position_);
+    Cruise_ship(const std::string &name_, Point position_,
+            const Ship_parameters* parameters_);
 
     // Update the state of the cruise ship
     void update() override;
@@ -31,6 +32,16 @@ public:
     // Output a description of the state of the cruise ship to cout
     void describe() const override;
 
+    // Include the islands left to visit
+    std::size_t get_memory_size() const override
+        { return sizeof(Cruise_ship) + Ship::get_memory_size() +
+            get_tree_memory_size(islands_to_visit); }
+
+
+    // Save and restore the cruise state along with the Ship state
+    void save_state(Snapshot_writer& writer) const override;
+    void restore_state(Snapshot_reader& reader) override;
+
     // Cancel currnet cruise and stop the ship
     void stop() override;
 
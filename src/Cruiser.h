@@ -14,13 +14,18 @@
 class Cruiser : public Warship {
 public:
     // initialize the cruiser
-    Cruiser(const std::string& name_, Point position_);
+    Cruiser(const std::string& name_, Point position_,
+            const Ship_parameters* parameters_);
 
     // Add type of ship to description
     void describe() const override;
 
+    // Bytes used by the cruiser
+    std::size_t get_memory_size() const override
+        { return sizeof(Cruiser) + Ship::get_memory_size(); }
+
     // respond to an attack by counter attacking
-    void receive_hit(int hit_force, std::shared_ptr<Ship_component> attacker_ptr) override;
+    void react_to_hit(std::shared_ptr<Ship_component> attacker_ptr) override;
 protected:
     // If the target is out of range, stop the attack
     void target_out_of_range_handler() override;
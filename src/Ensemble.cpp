@@ -0,0 +1,340 @@
+#include "Ensemble.h"
+
+#include "Controller.h"
+#include "Model.h"
+#include "View.h"
+#include "Ship_parameters.h"
+#include "Utility.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <thread>
+#include <limits>
+#include <algorithm>
+
+#include <unistd.h>
+#include <poll.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+/* Runs the variants of an ensemble in forked processes and aggregates the outcome
+ * reports that the processes send back. See Ensemble.h for the spec file format.
+ */
+
+const int ensemble_column_width_c = 10;
+const size_t ensemble_read_chunk_c = 4096;
+
+/* Outcome_view
+ * Watches the fuel and removal notifications of every ship in a variant so that
+ * the fate of each ship can be reported when the scenario is over.
+ */
+class Outcome_view : public View {
+public:
+    // Track the last fuel level reported for a ship
+    void update_fuel(const string& name, double fuel) override
+        { outcomes[name].fuel = fuel; }
+
+    // A ship is only removed from the views when it sinks
+    void update_remove(const string& name) override
+        { outcomes[name].sunk_time = Model::get_inst()->get_time(); }
+
+    // Nothing to draw, the outcomes are reported by report()
+    void draw() const override { }
+
+    // Write a "ship <name> <sunk_time> <fuel>" line for every ship seen
+    void report(ostream& os) const;
+
+private:
+    struct Outcome {
+        double fuel = 0.;
+        int sunk_time = -1; // -1 if the ship is still afloat
+    };
+    map<string, Outcome> outcomes;
+};
+
+void Outcome_view::report(ostream& os) const {
+    for (auto& outcome_pair : outcomes) {
+        os << "ship " << outcome_pair.first << ' ' << outcome_pair.second.sunk_time <<
+                ' ' << outcome_pair.second.fuel << '\n';
+    }
+}
+
+static string read_file(const string& file_name, const char* error_msg);
+static string directory_of(const string& file_name);
+static string substitute_placeholder(string text, const string& name, double value);
+static void write_all(int fd, const string& data);
+
+/* Spec reading */
+
+// Read the spec file one directive at a time
+Ensemble_spec read_ensemble_spec(const string& spec_file) {
+    istringstream spec_stream(read_file(spec_file, "Could not open ensemble spec file!"));
+    Ensemble_spec spec;
+    bool have_scenario = false;
+    string line;
+    while (getline(spec_stream, line)) {
+        istringstream line_stream(line);
+        string directive;
+        if (!(line_stream >> directive) || directive[0] == '#')
+            continue;
+
+        if (directive == "scenario") {
+            string scenario_file;
+            line_stream >> scenario_file;
+            if (!scenario_file.empty() && scenario_file[0] != '/')
+                scenario_file = directory_of(spec_file) + scenario_file;
+            spec.scenario = read_file(scenario_file, "Could not open scenario file!");
+            have_scenario = true;
+        } else if (directive == "runs") {
+            line_stream >> spec.runs;
+        } else if (directive == "jobs") {
+            line_stream >> spec.jobs;
+        } else if (directive == "seed") {
+            line_stream >> spec.seed;
+        } else if (directive == "vary") {
+            Ensemble_range range;
+            line_stream >> range.name >> range.low >> range.high;
+            spec.placeholders.push_back(range);
+        } else if (directive == "param") {
+            Ensemble_range range;
+            line_stream >> range.type >> range.name >> range.low >> range.high;
+            spec.parameters.push_back(range);
+        } else {
+            throw Error("Invalid ensemble spec!");
+        }
+
+        if (!line_stream || spec.runs <= 0 || spec.jobs < 0)
+            throw Error("Invalid ensemble spec!");
+    }
+    if (!have_scenario)
+        throw Error("Invalid ensemble spec!");
+    return spec;
+}
+
+/* Ensemble_runner public member functions */
+
+Ensemble_runner::Ensemble_runner(const Ensemble_spec& spec_) : spec(spec_) { }
+
+// Keep up to spec.jobs variants running at once, reading each report as it
+// arrives so that no child blocks on a full pipe.
+void Ensemble_runner::run() {
+    size_t jobs = spec.jobs > 0 ? spec.jobs : max(1u, thread::hardware_concurrency());
+
+    struct Running_variant {
+        pid_t pid;
+        int fd;
+        string report;
+    };
+    vector<Running_variant> running;
+    int next_index = 0;
+
+    while (next_index < spec.runs || !running.empty()) {
+        // Start as many variants as we are allowed to
+        while (next_index < spec.runs && running.size() < jobs) {
+            int pipe_fds[2];
+            if (pipe(pipe_fds) != 0)
+                throw Error("Could not start ensemble run!");
+            // Don't let the child inherit anything still waiting to be written
+            cout.flush();
+            pid_t pid = fork();
+            if (pid < 0)
+                throw Error("Could not start ensemble run!");
+            if (pid == 0) {
+                close(pipe_fds[0]);
+                // Don't let the child hold the other children's pipes open
+                for (auto& variant : running)
+                    close(variant.fd);
+                run_variant(next_index, pipe_fds[1]);
+                // Leave without running destructors or flushing the parent's buffers
+                _exit(0);
+            }
+            close(pipe_fds[1]);
+            running.push_back({pid, pipe_fds[0], ""});
+            ++next_index;
+        }
+
+        // Wait for output from any running variant
+        vector<pollfd> poll_fds;
+        for (auto& variant : running)
+            poll_fds.push_back({variant.fd, POLLIN, 0});
+        if (poll(poll_fds.data(), poll_fds.size(), -1) < 0)
+            continue;
+
+        for (size_t i = poll_fds.size(); i-- > 0;) {
+            if (!poll_fds[i].revents)
+                continue;
+            Running_variant& variant = running[i];
+            char buffer[ensemble_read_chunk_c];
+            ssize_t count = read(variant.fd, buffer, sizeof(buffer));
+            if (count > 0) {
+                variant.report.append(buffer, count);
+                continue;
+            }
+            // End of the report, the variant is done
+            close(variant.fd);
+            int status;
+            waitpid(variant.pid, &status, 0);
+            if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+                collect(variant.report);
+            else
+                errors.push_back("Ensemble run terminated abnormally!");
+            running.erase(running.begin() + i);
+        }
+    }
+}
+
+// Print one row per ship with its aggregated outcome
+void Ensemble_runner::print_summary() const {
+    cout << "Ensemble of " << spec.runs << " runs, " << completed_runs << " completed";
+    if (completed_runs > 0)
+        cout << ", ending at tick " << double(end_time_total) / completed_runs << " on average";
+    cout << endl;
+    if (!errors.empty())
+        cout << errors.size() << " runs failed: " << errors.front() << endl;
+
+    const int w = ensemble_column_width_c;
+    cout << setw(w + 4) << "Ship" << setw(w) << "Runs" << setw(w) << "Sunk %" <<
+            setw(w) << "Sunk at" << setw(w) << "First" << setw(w) << "Last" <<
+            setw(w) << "Fuel left" << setw(w) << "Min fuel" << endl;
+    for (auto& stats_pair : ship_stats) {
+        const Ship_stats& stats = stats_pair.second;
+        int afloat = stats.runs - stats.sunk;
+        cout << setw(w + 4) << stats_pair.first << setw(w) << stats.runs <<
+                setw(w) << 100. * stats.sunk / stats.runs;
+        if (stats.sunk > 0)
+            cout << setw(w) << double(stats.sunk_time_total) / stats.sunk <<
+                    setw(w) << stats.first_sunk_time << setw(w) << stats.last_sunk_time;
+        else
+            cout << setw(w) << "-" << setw(w) << "-" << setw(w) << "-";
+        if (afloat > 0)
+            cout << setw(w) << stats.fuel_total / afloat << setw(w) << stats.min_fuel;
+        else
+            cout << setw(w) << "-" << setw(w) << "-";
+        cout << endl;
+    }
+}
+
+/* Ensemble_runner private member functions */
+
+// Draw this variant's values, run the scenario with all output discarded, and
+// report what happened to each ship.
+void Ensemble_runner::run_variant(int index, int out_fd) const {
+    ostringstream report;
+    report << setprecision(numeric_limits<double>::max_digits10);
+    try {
+        seed_seq seeds {spec.seed, static_cast<unsigned long>(index)};
+        mt19937_64 generator(seeds);
+
+        // Parameters must be set before the Model creates its initial ships
+        for (auto& range : spec.parameters) {
+            uniform_real_distribution<double> distribution(range.low, range.high);
+            set_ship_parameter(range.type, range.name, distribution(generator));
+        }
+        string scenario = spec.scenario;
+        for (auto& range : spec.placeholders) {
+            uniform_real_distribution<double> distribution(range.low, range.high);
+            scenario = substitute_placeholder(scenario, range.name, distribution(generator));
+        }
+        // Make sure the controller stops at the end of the scenario
+        istringstream scenario_stream(scenario + "\nquit\n");
+
+        Null_buffer null_buffer;
+        cin.rdbuf(scenario_stream.rdbuf());
+        cout.rdbuf(&null_buffer);
+
+        auto outcome_view = make_shared<Outcome_view>();
+        Model::get_inst()->attach(outcome_view);
+        Controller controller;
+        controller.run();
+
+        outcome_view->report(report);
+        report << "time " << Model::get_inst()->get_time() << '\n';
+    } catch (Error& e) {
+        report << "error " << e.what() << '\n';
+    }
+    write_all(out_fd, report.str());
+    close(out_fd);
+}
+
+// Parse a variant's report and add it to the statistics of each ship
+void Ensemble_runner::collect(const string& report) {
+    istringstream report_stream(report);
+    string line;
+    while (getline(report_stream, line)) {
+        istringstream line_stream(line);
+        string kind;
+        line_stream >> kind;
+        if (kind == "error") {
+            errors.push_back(line.substr(kind.size() + 1));
+            return;
+        } else if (kind == "time") {
+            int end_time;
+            line_stream >> end_time;
+            end_time_total += end_time;
+        } else if (kind == "ship") {
+            string name;
+            int sunk_time;
+            double fuel;
+            line_stream >> name >> sunk_time >> fuel;
+            Ship_stats& stats = ship_stats[name];
+            ++stats.runs;
+            if (sunk_time >= 0) {
+                stats.first_sunk_time = stats.sunk ?
+                        min(stats.first_sunk_time, sunk_time) : sunk_time;
+                stats.last_sunk_time = max(stats.last_sunk_time, sunk_time);
+                stats.sunk_time_total += sunk_time;
+                ++stats.sunk;
+            } else {
+                stats.min_fuel = stats.runs - stats.sunk > 1 ?
+                        min(stats.min_fuel, fuel) : fuel;
+                stats.fuel_total += fuel;
+            }
+        }
+    }
+    ++completed_runs;
+}
+
+/* Helper functions */
+
+// Read the entire contents of a file, throw error_msg if it can't be opened
+static string read_file(const string& file_name, const char* error_msg) {
+    ifstream file(file_name);
+    if (!file)
+        throw Error(error_msg);
+    ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+// Return the directory part of a file name, including the trailing '/'
+static string directory_of(const string& file_name) {
+    auto slash_pos = file_name.rfind('/');
+    return slash_pos == string::npos ? "" : file_name.substr(0, slash_pos + 1);
+}
+
+// Replace every ${name} in text with value
+static string substitute_placeholder(string text, const string& name, double value) {
+    const string placeholder = "${" + name + "}";
+    ostringstream value_stream;
+    value_stream << value;
+    const string value_text = value_stream.str();
+    for (auto pos = text.find(placeholder); pos != string::npos;
+            pos = text.find(placeholder, pos + value_text.size()))
+        text.replace(pos, placeholder.size(), value_text);
+    return text;
+}
+
+// Write all of data to fd, retrying partial writes
+static void write_all(int fd, const string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t count = write(fd, data.data() + written, data.size() - written);
+        if (count <= 0)
+            return;
+        written += count;
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+/* Ensemble runner
+ *
+ * Runs many variations of a base scenario and aggregates what happened to each
+ * ship: how often it was sunk, at which tick, and how much fuel it had left.
+ *
+ * An ensemble is described by a spec file with one directive per line. Blank lines
+ * and lines starting with '#' are ignored.
+ *
+ *   scenario <file>                      commands to run, relative to the spec file
+ *   runs <n>                             number of variants to run (default 100)
+ *   jobs <n>                             variants run at once, 0 is one per core (default 0)
+ *   seed <n>                             seed for drawing the variants (default 1)
+ *   vary <name> <low> <high>             replace ${name} in the scenario with a value
+ *                                        drawn uniformly from [low, high]
+ *   param <type> <field> <low> <high>    override a Ship_parameters field of a ship
+ *                                        type with a value drawn uniformly from [low, high]
+ *
+ * Each variant draws its values from a generator seeded with the seed and the
+ * variant's index, so the same spec always produces the same results no matter
+ * how many jobs are used.
+ *
+ * The Model is a singleton and all objects write to cout, so every variant runs in
+ * its own forked process with its output discarded. The process watches the ships
+ * with a View and reports their fate back to the runner through a pipe.
+ */
+
+// A parameter that is varied across the ensemble
+struct Ensemble_range {
+    std::string type;   // Ship type for "param" directives, empty for "vary"
+    std::string name;   // Placeholder name or Ship_parameters field name
+    double low;
+    double high;
+};
+
+// Description of an ensemble, see above for the spec file format
+struct Ensemble_spec {
+    std::string scenario;   // Text of the base scenario
+    int runs = 100;
+    int jobs = 0;
+    unsigned long seed = 1;
+    std::vector<Ensemble_range> placeholders;
+    std::vector<Ensemble_range> parameters;
+};
+
+// Read an ensemble spec from a file.
+// May throw Error("Could not open ensemble spec file!"),
+// Error("Could not open scenario file!"), or Error("Invalid ensemble spec!")
+Ensemble_spec read_ensemble_spec(const std::string& spec_file);
+
+class Ensemble_runner {
+public:
+    Ensemble_runner(const Ensemble_spec& spec_);
+
+    // Run every variant of the ensemble, using up to spec.jobs processes at once.
+    // May throw Error("Could not start ensemble run!")
+    void run();
+
+    // Print a table of the aggregated outcomes to cout
+    void print_summary() const;
+
+private:
+    // Aggregated outcome of a single ship across the ensemble
+    struct Ship_stats {
+        int runs = 0;           // Runs in which the ship existed
+        int sunk = 0;           // Runs in which the ship was sunk
+        long sunk_time_total = 0;
+        int first_sunk_time = 0;
+        int last_sunk_time = 0;
+        double fuel_total = 0.; // Fuel left at the end of runs where it stayed afloat
+        double min_fuel = 0.;
+    };
+
+    Ensemble_spec spec;
+    std::map<std::string, Ship_stats> ship_stats;
+    int completed_runs = 0;
+    long end_time_total = 0;
+    std::vector<std::string> errors;    // Errors reported by failed variants
+
+    // Run variant number `index` in this process and write its report to out_fd.
+    // Called in the forked child.
+    void run_variant(int index, int out_fd) const;
+
+    // Add the report of a finished variant to the aggregated outcomes
+    void collect(const std::string& report);
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "Formation.h"
+
+#include "Navigation.h"
+
+using namespace std;
+
+/* Public member functions */
+
+Formation::Formation(Point position, double course, double speed) :
+        track_base(position, Course_speed(course, speed)),
+        has_destination(false) { }
+
+// Head straight for the destination
+Formation::Formation(Point position, double speed, Point destination_) :
+        track_base(position,
+                Course_speed(Compass_vector(position, destination_).direction, speed)),
+        has_destination(true), destination(destination_) { }
+
+// Stop at the destination if it is within a tick's travel, like a ship does
+void Formation::advance(int time) {
+    if (time == advanced_time || arrived)
+        return;
+    advanced_time = time;
+    double destination_distance = has_destination ?
+            cartesian_distance(get_position(), destination) : 0.;
+    if (has_destination && destination_distance <= track_base.get_speed()) {
+        track_base.set_position(destination);
+        step_distance = destination_distance;
+        arrived = true;
+    } else {
+        track_base.update_position(1.0);
+        step_distance = track_base.get_speed();
+    }
+}
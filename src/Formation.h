@@ -0,0 +1,50 @@
+#ifndef FORMATION_H
+#define FORMATION_H
+
+#include "Track_base.h"
+
+/* Formation
+ *
+ * The movement shared by the ships of a group that sails in formation. A formation
+ * is a single reference point that moves like a ship, starting at the leader's
+ * position, and each ship in it keeps a fixed offset from that point.
+ *
+ * The reference point is moved once per tick, by the first of its ships to update
+ * in that tick, and every ship then takes its new position from it. This means a
+ * formation of any size needs only one navigation update per tick.
+ */
+
+class Formation {
+public:
+    // Start at position, sailing on course at speed
+    Formation(Point position, double course, double speed);
+
+    // Start at position, sailing to destination at speed
+    Formation(Point position, double speed, Point destination_);
+
+    // Move the reference point for the tick at time, does nothing if it has
+    // already been moved for that time
+    void advance(int time);
+
+    // Current position of the reference point
+    Point get_position() const
+        { return track_base.get_position(); }
+
+    // Distance the reference point moved in the last tick
+    double get_step_distance() const
+        { return step_distance; }
+
+    // True once the reference point has reached the destination
+    bool has_arrived() const
+        { return arrived; }
+
+private:
+    Track_base track_base;
+    bool has_destination;
+    Point destination;
+    int advanced_time = -1; // time of the last tick the point was moved for
+    double step_distance = 0.;
+    bool arrived = false;
+};
+
+#endif
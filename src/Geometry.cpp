@@ -36,6 +36,14 @@ double cartesian_distance (const Point& p1, const Point& p2)
 	return d;
 }
 
+// return the square of the distance between two Points
+double cartesian_distance_squared (const Point& p1, const Point& p2)
+{
+	double xd = p2.x - p1.x;
+	double yd = p2.y - p1.y;
+	return xd * xd + yd * yd;
+}
+
 // Cartesian_vector members
 // construct a Cartesian_vector from two Points,
 // showing the vector from p1 to p2 
@@ -52,6 +52,10 @@ struct Point
 // return the distance between two Points
 double cartesian_distance (const Point& p1, const Point& p2);
 
+// return the square of the distance between two Points; comparing squared distances
+// gives the same answer as comparing distances, without taking square roots
+double cartesian_distance_squared (const Point& p1, const Point& p2);
+
 /* Cartesian_vector */
 // A Cartesian_vector contains an x, y displacement
 struct Cartesian_vector
@@ -76,7 +76,7 @@ void Grid_location_view::draw(int width, int height, double scale, Point origin)
         } else {
             // If more than one object is in the same cell, use the multiple entry cell
             if (grid[iy][ix] == empty_cell_c)
-                grid[iy][ix] = loc_name.substr(0, name_abbreviation_length_c);
+                grid[iy][ix].assign(loc_name, 0, name_abbreviation_length_c);
             else
                 grid[iy][ix] = multiple_entry_cell_c;
         }
@@ -0,0 +1,21 @@
+#ifndef GROUP_SUMMARY_H
+#define GROUP_SUMMARY_H
+
+#include "Geometry.h"
+
+/* Group_summary
+ * The aggregate state of the individual ships of a group and its subgroups, as
+ * kept up to date by Ship_group and sent to the views. The positions and fuel
+ * values are only meaningful if the group has at least one ship.
+ */
+
+struct Group_summary {
+    int ship_count = 0;
+    Point centroid;         // average position of the ships
+    Point bounds_low;       // corners of the smallest box holding every ship
+    Point bounds_high;
+    double total_fuel = 0.;
+    double min_fuel = 0.;
+};
+
+#endif
@@ -1,31 +1,53 @@
 #include "Island.h"
 
 #include "Model.h"
+#include "Ship.h"
+#include "Snapshot.h"
+#include "Utility.h"
 
 #include <iostream>
+#include <sstream>
+#include <algorithm>
 
 using namespace std;
 
+vector<Island*> Island::islands_with_requests;
+
 /* Island class keeps track of data associated with an island. An island can
  * create and/or store oil at the island for ships to use to refuel.
  */
 
 // Construct an island
-Island::Island(const std::string &name_, Point position_, double fuel_,
-        double production_rate_) : Sim_object(name_), position(position_),
-        fuel(fuel_), production_rate(production_rate_) { }
+Island::Island(const std::string &name_, Point position_, Island_fuel_table& fuel_table_,
+        double fuel_, double production_rate_) : Sim_object(name_), position(position_),
+        fuel_table(&fuel_table_), fuel_index(fuel_table_.add(fuel_, production_rate_)) { }
 
 // Update the island by producing some fuel
 void Island::update() {
     // Production rate is assumed to be on a per hour basis according to the spec.
+    double production_rate = get_production_rate();
     if (production_rate > 0.)
         accept_fuel(production_rate);
 }
 
+// The messages are formatted like cout into a buffer, so the output is the same
+// as updating the islands one by one but is only flushed once
+void Island::update_producing(Island_fuel_table& fuel_table,
+        const vector<Island*>& producing_islands) {
+    fuel_table.produce();
+
+    ostringstream messages;
+    messages.copyfmt(cout);
+    for (Island* island_ptr : producing_islands)
+        messages << "Island " << island_ptr->get_name() << " now has " <<
+                island_ptr->get_fuel() << " tons\n";
+    cout << messages.str() << flush;
+}
+
 // Describe the island
 void Island::describe() const {
     cout << "\nIsland " << get_name() << " at position " << position << endl;
-    cout << "Fuel available: " << fuel << " tons" << endl;
+    cout << "Fuel available: " << get_fuel() << " tons" << endl;
 }
 
 // Broadcast the location of the island if requested to
@@ -35,9 +57,10 @@ void Island::broadcast_current_state() const {
 
 // Provide some fuel we have in storage to a requesting ship
 double Island::provide_fuel(double request) {
+    double fuel = get_fuel();
     if (request > fuel)
         request = fuel;
-    fuel -= request;
+    set_fuel(fuel - request);
     cout << "Island " << get_name() << " supplied " <<
             request << " tons of fuel" << endl;
     return request;
@@ -45,6 +68,123 @@ double Island::provide_fuel(double request) {
 
 // Add some fuel to the island's fuel storage
 void Island::accept_fuel(double amount) {
-    fuel += amount;
-    cout << "Island " << get_name() << " now has " << fuel << " tons" << endl;
+    set_fuel(get_fuel() + amount);
+    cout << "Island " << get_name() << " now has " << get_fuel() << " tons" << endl;
+}
+
+// Queue the request, and have the Model resolve the requests at the end of the
+// update if it is the first one of any island
+void Island::request_fuel(shared_ptr<Ship> requester, double request,
+        function<void (double)> deliver) {
+    Model* model_ptr = Model::get_inst();
+    if (model_ptr->get_fuel_allocation() == Model::Fuel_allocation_t::immediate ||
+            !model_ptr->is_updating()) {
+        deliver(provide_fuel(request));
+        return;
+    }
+    if (islands_with_requests.empty())
+        model_ptr->schedule_update_phase(&Island::resolve_fuel_requests);
+    if (fuel_requests.empty())
+        islands_with_requests.push_back(this);
+    fuel_requests.push_back({requester, request, move(deliver)});
+}
+
+// Include the ships waiting for fuel
+size_t Island::get_memory_size() const {
+    return sizeof(Island) + get_tree_memory_size(waiting_since);
+}
+
+// Each island is resolved on its own, in the order of the first requests
+void Island::resolve_fuel_requests() {
+    vector<Island*> islands;
+    islands.swap(islands_with_requests);
+    for (Island* island_ptr : islands)
+        island_ptr->allocate_fuel();
+}
+
+// Ships that have sunk since asking get nothing. Each ship that is served is told
+// what it got just after the island says what it supplied, as with provide_fuel().
+// A ship keeps its place in the fifo queue as long as it keeps asking every update
+// without being served in full. Its entry is only looked at when the island next
+// allocates, so a ship that comes back after a gap is found to have stopped
+// waiting by when it last asked, even if nobody asked here meanwhile.
+void Island::allocate_fuel() {
+    vector<Fuel_request> requests;
+    requests.swap(fuel_requests);
+    requests.erase(remove_if(requests.begin(), requests.end(),
+            [](const Fuel_request& fuel_request) { return !fuel_request.requester->is_afloat(); }),
+            requests.end());
+
+    int time = Model::get_inst()->get_time();
+    map<string, Waiting> new_waiting_since;
+    for (auto& fuel_request : requests) {
+        auto& name = fuel_request.requester->get_name();
+        auto waiting_it = waiting_since.find(name);
+        bool kept_waiting = waiting_it != waiting_since.end() &&
+                waiting_it->second.last_request >= time - 1;
+        new_waiting_since[name] = {kept_waiting ? waiting_it->second.since : time, time};
+    }
+
+    double fuel = get_fuel();
+    vector<double> amounts(requests.size());
+    double total_request = 0.;
+    for (auto& fuel_request : requests)
+        total_request += fuel_request.request;
+    if (total_request <= fuel) {
+        for (size_t i = 0; i < requests.size(); ++i)
+            amounts[i] = requests[i].request;
+    } else if (Model::get_inst()->get_fuel_allocation() == Model::Fuel_allocation_t::pro_rata) {
+        for (size_t i = 0; i < requests.size(); ++i)
+            amounts[i] = fuel * requests[i].request / total_request;
+    } else {
+        vector<size_t> order(requests.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+            return new_waiting_since[requests[lhs].requester->get_name()].since <
+                    new_waiting_since[requests[rhs].requester->get_name()].since;
+        });
+        double fuel_left = fuel;
+        for (size_t i : order) {
+            amounts[i] = min(requests[i].request, fuel_left);
+            fuel_left -= amounts[i];
+        }
+    }
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (amounts[i] >= requests[i].request - double_close_enough_c)
+            new_waiting_since.erase(requests[i].requester->get_name());
+        set_fuel(max(get_fuel() - amounts[i], 0.));
+        cout << "Island " << get_name() << " supplied " <<
+                amounts[i] << " tons of fuel" << endl;
+        requests[i].deliver(amounts[i]);
+    }
+    waiting_since.swap(new_waiting_since);
+}
+
+// Save the state of the island
+void Island::save_state(Snapshot_writer& writer) const {
+    writer.write_point(position);
+    writer.write_double(get_fuel());
+    writer.write_double(get_production_rate());
+    writer.write_int(static_cast<int>(waiting_since.size()));
+    for (auto& waiting_pair : waiting_since) {
+        writer.write_string(waiting_pair.first);
+        writer.write_int(waiting_pair.second.since);
+        writer.write_int(waiting_pair.second.last_request);
+    }
+}
+
+// Restore the state of the island
+void Island::restore_state(Snapshot_reader& reader) {
+    position = reader.read_point();
+    set_fuel(reader.read_double());
+    fuel_table->set_production_rate(fuel_index, reader.read_double());
+    waiting_since.clear();
+    int waiting_count = reader.read_int();
+    for (int i = 0; i < waiting_count; ++i) {
+        string name = reader.read_string();
+        int since = reader.read_int();
+        waiting_since[name] = {since, reader.read_int()};
+    }
 }
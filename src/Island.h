@@ -4,16 +4,37 @@
 /* Islands are a kind of Sim_object; they have an amount of fuel and a an amount by which it increases
 every update (default is zero). The can also provide or accept fuel, and update their amount
 accordingly.
+
+Ships docked at an island ask for fuel with request_fuel(). Normally the island provides
+what it can at once, so the ships that update first during an update get served first.
+When the Model's fuel allocation is fifo or pro_rata, the requests made during an update
+wait in the island's reservation queue, and once every object has updated, each island
+shares out its fuel among all of its requests together. With fifo allocation the requests
+are served in full in order of how long their ships have been asking, and with pro_rata
+allocation a short supply is split in proportion to the amounts asked for.
+
+An island's fuel and production rate are kept in an Island_fuel_table shared by
+the islands of the world, see Island_fuel_table.h, and the island keeps its index
+in the table.
 */
 
 #include "Sim_object.h"
 #include "Geometry.h"
+#include "Island_fuel_table.h"
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+
+class Ship;
 
 class Island : public Sim_object {
 public:
-    // initialize the island
-    Island(const std::string &name_, Point position_, double fuel_ = 0.,
-            double production_rate_ = 0.);
+    // initialize the island, adding its entry to fuel_table, which must last
+    // as long as the island
+    Island(const std::string &name_, Point position_, Island_fuel_table& fuel_table_,
+            double fuel_ = 0., double production_rate_ = 0.);
 
     // Get the location of the island
     Point get_location() const override { return position; }
@@ -21,9 +42,21 @@ public:
     // if production_rate > 0, compute production_rate * unit time, and add to amount, and print an update message
     void update() override;
 
+    // Return true if update() produces fuel
+    bool is_producing() const { return get_production_rate() > 0.; }
+
+    // Do what update() does for every island in fuel_table, with one pass over
+    // the table, and then output the messages of producing_islands, which must be
+    // the islands in the table that produce fuel, all at once
+    static void update_producing(Island_fuel_table& fuel_table,
+            const std::vector<Island*>& producing_islands);
+
     // output information about the current state
     void describe() const override;
 
+    // Bytes used by the island
+    std::size_t get_memory_size() const override;
+
     // ask model to notify views of current state
     void broadcast_current_state() const override;
 
@@ -34,9 +67,54 @@ public:
     // Add the amount to the amount on hand, and output the total as the amount the Island now has.
     void accept_fuel(double amount);
 
+    // Ask for request tons of fuel for requester, calling deliver with the amount
+    // provided. Outside of an update, or if the Model allocates fuel immediately,
+    // this is the same as calling deliver(provide_fuel(request)). Otherwise the
+    // request is queued, and deliver is called at the end of the update, with zero
+    // if none is left for it, unless the requester has sunk by then.
+    void request_fuel(std::shared_ptr<Ship> requester, double request,
+            std::function<void (double)> deliver);
+
+    // Save and restore the position, fuel, production rate, and the ships waiting
+    // for fuel
+    void save_state(Snapshot_writer& writer) const override;
+    void restore_state(Snapshot_reader& reader) override;
+
 private:
     Point position;             // Location of this island
-    double fuel;                // Fuel stored at island
-    double production_rate;     // Fuel generated per cycle
+    Island_fuel_table* fuel_table;  // Fuel stored at island, and generated per cycle
+    std::size_t fuel_index;         // This island's entry in fuel_table
+
+    double get_fuel() const
+        { return fuel_table->get_fuel(fuel_index); }
+    void set_fuel(double fuel)
+        { fuel_table->set_fuel(fuel_index, fuel); }
+    double get_production_rate() const
+        { return fuel_table->get_production_rate(fuel_index); }
+
+    // A request waiting for the end of the update
+    struct Fuel_request {
+        std::shared_ptr<Ship> requester;
+        double request;
+        std::function<void (double)> deliver;
+    };
+    std::vector<Fuel_request> fuel_requests;
+    // When each ship that has not yet been served in full started asking, and
+    // when it last asked, by ship name. A ship that did not ask on the update
+    // before this one has stopped waiting, and starts again at the back.
+    struct Waiting {
+        int since;
+        int last_request;
+    };
+    std::map<std::string, Waiting> waiting_since;
+
+    // The islands with requests waiting, in the order of their first request
+    static std::vector<Island*> islands_with_requests;
+
+    // Share out the fuel among the waiting requests of every island
+    static void resolve_fuel_requests();
+
+    // Share out this island's fuel among its waiting requests
+    void allocate_fuel();
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef ISLAND_FUEL_TABLE_H
+#define ISLAND_FUEL_TABLE_H
+
+#include <vector>
+#include <cstddef>
+
+/* Island_fuel_table
+ *
+ * The fuel stored at each island and the fuel it produces every update, kept in
+ * two arrays indexed by island instead of in the islands themselves, so that
+ * producing fuel for every island is one pass over contiguous memory that the
+ * compiler can vectorize. The Model owns the table for its islands, and each
+ * Island keeps its index in the table and reads and writes its fuel there.
+ *
+ * Entries are only ever added, so an island's index never changes. Islands that
+ * produce nothing have a production rate of zero, and adding it leaves their
+ * fuel as it was.
+ */
+
+class Island_fuel_table {
+public:
+    // Add an entry for a new island and return its index
+    std::size_t add(double fuel_, double production_rate_) {
+        fuel.push_back(fuel_);
+        production_rates.push_back(production_rate_);
+        return fuel.size() - 1;
+    }
+
+    double get_fuel(std::size_t index) const
+        { return fuel[index]; }
+    void set_fuel(std::size_t index, double fuel_)
+        { fuel[index] = fuel_; }
+
+    double get_production_rate(std::size_t index) const
+        { return production_rates[index]; }
+    void set_production_rate(std::size_t index, double production_rate_)
+        { production_rates[index] = production_rate_; }
+
+    // Add every island's production rate to its fuel
+    void produce() {
+        double* fuel_ptr = fuel.data();
+        const double* production_rate_ptr = production_rates.data();
+        std::size_t count = fuel.size();
+        for (std::size_t i = 0; i < count; ++i)
+            fuel_ptr[i] += production_rate_ptr[i];
+    }
+
+    // Bytes used by the arrays
+    std::size_t get_memory_size() const
+        { return (fuel.capacity() + production_rates.capacity()) * sizeof(double); }
+
+private:
+    std::vector<double> fuel;
+    std::vector<double> production_rates;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include "Journal.h"
+
+#include "Model.h"
+#include "Utility.h"
+
+#include <sstream>
+
+using namespace std;
+
+/* Journal */
+
+// Open the journal and start it with a snapshot of the current simulation
+Journal::Journal(const string& file_name_, int snapshot_interval_) :
+        file_name(file_name_), snapshot_interval(snapshot_interval_),
+        file(file_name_, ios::trunc) {
+    if (!file)
+        throw Error("Could not write journal file!");
+    record_snapshot();
+}
+
+// Commands are flushed as they are recorded so the journal survives a crash
+void Journal::record_command(int time, const string& command_text) {
+    file << time << ' ' << command_text << endl;
+}
+
+// Snapshots are numbered rather than named after the time, since the simulation
+// may go back in time and pass through the same time again.
+void Journal::record_snapshot() {
+    string snapshot_file = file_name + '.' + to_string(++snapshot_count) + ".snap";
+    Model::get_inst()->save_snapshot(snapshot_file);
+    last_snapshot_time = Model::get_inst()->get_time();
+
+    // Snapshots are found relative to the journal when replaying
+    auto slash_pos = snapshot_file.rfind('/');
+    if (slash_pos != string::npos)
+        snapshot_file.erase(0, slash_pos + 1);
+    file << "snapshot " << last_snapshot_time << ' ' << snapshot_file << endl;
+}
+
+// Take a snapshot whenever the time reaches a multiple of the interval
+void Journal::snapshot_if_due() {
+    int time = Model::get_inst()->get_time();
+    if (time != last_snapshot_time && time % snapshot_interval == 0)
+        record_snapshot();
+}
+
+/* Replay */
+
+// Scan the whole journal, restarting the list of commands at every usable snapshot
+Journal_replay find_replay(const string& journal_file, int time) {
+    ifstream file(journal_file);
+    if (!file)
+        throw Error("Could not open journal file!");
+
+    Journal_replay replay;
+    bool collecting = false;    // True while following a snapshot taken at or before time
+    string line;
+    while (getline(file, line)) {
+        istringstream line_stream(line);
+        string first_word;
+        line_stream >> first_word;
+        if (first_word == "snapshot") {
+            int snapshot_time;
+            string snapshot_file;
+            if (!(line_stream >> snapshot_time >> snapshot_file))
+                throw Error("Invalid journal file!");
+            collecting = snapshot_time <= time;
+            if (collecting) {
+                replay.snapshot_file = snapshot_file;
+                replay.commands.clear();
+            }
+        } else {
+            istringstream time_stream(first_word);
+            int command_time;
+            if (!(time_stream >> command_time))
+                throw Error("Invalid journal file!");
+            if (collecting && command_time < time) {
+                string command_text;
+                getline(line_stream >> ws, command_text);
+                replay.commands.push_back(command_text);
+            }
+        }
+    }
+    if (replay.snapshot_file.empty())
+        throw Error("Time is not covered by the journal!");
+
+    auto slash_pos = journal_file.rfind('/');
+    if (slash_pos != string::npos)
+        replay.snapshot_file.insert(0, journal_file, 0, slash_pos + 1);
+    return replay;
+}
@@ -0,0 +1,61 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+/* Command journal
+ *
+ * A journal is an append-only text file recording every command that changed the
+ * simulation, each with the time at which it was entered, interleaved with
+ * snapshots of the world taken every snapshot_interval ticks:
+ *
+ *   snapshot <time> <snapshot_file>
+ *   <time> <command text>
+ *
+ * Snapshot files are written next to the journal, and are named after the journal
+ * and the number of the snapshot. The simulation is deterministic, so the state at
+ * any time can be reproduced by loading the last snapshot taken at or before that
+ * time and running only the commands entered after it; see find_replay().
+ */
+
+class Journal {
+public:
+    // Start a new journal in file_name_, writing a snapshot now and then every
+    // snapshot_interval_ ticks.
+    // May throw Error("Could not write journal file!") or any error of
+    // Model::save_snapshot()
+    Journal(const std::string& file_name_, int snapshot_interval_);
+
+    // Record a command entered at time that changed the simulation
+    void record_command(int time, const std::string& command_text);
+
+    // Write a snapshot of the simulation and record it in the journal
+    void record_snapshot();
+
+    // Record a snapshot if the simulation has reached the next snapshot time
+    void snapshot_if_due();
+
+private:
+    std::string file_name;
+    int snapshot_interval;
+    int snapshot_count = 0;
+    int last_snapshot_time = 0;
+    std::ofstream file;
+};
+
+// What is needed to reproduce the simulation at a given time from a journal
+struct Journal_replay {
+    std::string snapshot_file;          // Snapshot to load
+    std::vector<std::string> commands;  // Commands to run after loading it
+};
+
+// Find the last snapshot in the journal taken at or before time, and the commands
+// entered after it and before time. If the journal went back in time with "load"
+// or "replay", the last time the simulation passed through time is used.
+// May throw Error("Could not open journal file!"), Error("Invalid journal file!"),
+// or Error("Time is not covered by the journal!")
+Journal_replay find_replay(const std::string& journal_file, int time);
+
+#endif
@@ -3,12 +3,20 @@
 #include "Ship_component.h"
 #include "Island.h"
 #include "Ship_factory.h"
+#include "Ship_parameters.h"
 #include "Utility.h"
 #include "View.h"
+#include "Snapshot.h"
 
 #include <iostream>
 #include <algorithm>
+#include <functional>
 #include <cassert>
+#include <fstream>
+#include <map>
+
+#include <unistd.h>
+#include <sys/wait.h>
 
 using namespace std;
 using namespace std::placeholders;
@@ -19,60 +27,65 @@ using namespace std::placeholders;
  * in the static global Model_destroyer object at the end of the program's life.
  */
 
+// Snapshot files start with this string followed by the format version.
+// Increment the version whenever the state saved by any object changes.
+const char* const snapshot_magic_c = "P6SNAP";
+const int snapshot_version_c = 9;
+
 /*************** Model ***************/
 // Initial value of Model's singleton pointer.
 Model *Model::singleton_ptr = nullptr;
 
+// Notifications are sent directly unless a thread sets a queue
+thread_local Model::Notification_queue_t* Model::notification_queue = nullptr;
+
 /* Public member functions*/
 
 // Construct the basis of our simulation.
-Model::Model() {
-    insert_island(make_shared<Island>("Exxon", Point(10, 10), 1000, 200));
-    insert_island(make_shared<Island>("Shell", Point(0, 30), 1000, 200));
-    insert_island(make_shared<Island>("Bermuda", Point(20, 20)));
-    insert_island(make_shared<Island>("Treasure_Island", Point(50, 5), 100, 5));
+Model::Model() : island_fuel_table(new Island_fuel_table) {
+    insert_island(make_shared<Island>("Exxon", Point(10, 10), *island_fuel_table, 1000, 200));
+    insert_island(make_shared<Island>("Shell", Point(0, 30), *island_fuel_table, 1000, 200));
+    insert_island(make_shared<Island>("Bermuda", Point(20, 20), *island_fuel_table));
+    insert_island(make_shared<Island>("Treasure_Island", Point(50, 5), *island_fuel_table,
+            100, 5));
 
     insert_ship(create_ship("Ajax", "Cruiser", Point(15, 15)));
     insert_ship(create_ship("Xerxes", "Cruiser", Point(25, 25)));
     insert_ship(create_ship("Valdez", "Tanker", Point(30, 30)));
 }
 
-// Check if a name is in use
+// Check if a name is in use. An identical name has the same abbreviation, so only
+// the abbreviations need to be checked.
 bool Model::is_name_in_use(const std::string& name) const {
-    // lower_bound will match an abbreviated name with an object with the same
-    // abbreviation if such an object exists in the object_map. If the abbreviation of the object
-    // is the same as the found object in the object map's name, then the name is in use.
-    string abrv_name = name.substr(0, name_abbreviation_length_c);
-    auto itt = object_map.lower_bound(abrv_name);
-    return itt != object_map.end() &&
-            itt->first.substr(0, name_abbreviation_length_c) == abrv_name;
+    return abbreviations.is_abbreviation_in_use(name);
 }
 
 // Checks if an island exists in the simulation
 bool Model::is_island_present(const std::string& name) const {
-    return island_map.find(name) != island_map.end();
+    return islands.contains(name);
 }
 
-// Gets an island_ptr from the island_map based on the island's name.
+// Gets an island_ptr from the islands based on the island's name.
 shared_ptr<Island> Model::get_island_ptr(const std::string& name) const {
-    auto itt = island_map.find(name);
-    if (itt == island_map.end())
+    auto island_ptr = islands.find(name);
+    if (!island_ptr)
         throw Error("Island not found!");
-    return itt->second;
+    return island_ptr;
 }
 
 // Gets a vector of all Island pointers from the model.
 vector<shared_ptr<Island>> Model::get_vector_of_islands() const {
     vector<shared_ptr<Island>> island_vect;
-    transform(island_map.begin(), island_map.end(),
+    island_vect.reserve(islands.size());
+    transform(islands.get_entries().begin(), islands.get_entries().end(),
             back_inserter(island_vect),
-            mem_fn(&IslandMap_t::value_type::second));
+            mem_fn(&Islands_t::Entry_t::second));
     return island_vect;
 }
 
 // Checks if a ship currently exists in the simulation
 bool Model::is_ship_present(const std::string& name) const {
-    return ship_map.find(name) != ship_map.end();
+    return ships.contains(name);
 }
 
 // Adds a ship to the model, and updates all the views
@@ -81,43 +94,310 @@ void Model::add_ship(std::shared_ptr<Ship_component> ship_ptr) {
     ship_ptr->broadcast_current_state();
 }
 
+// Find a ship's pointer based on the name of the ship, without throwing.
+shared_ptr<Ship_component> Model::find_ship_ptr(const string& name) const {
+    return ships.find(name);
+}
+
+// Select ships in a single pass over the ships, skipping any removed during an update
+vector<shared_ptr<Ship_component>> Model::get_vector_of_ships_if(
+        const function<bool (const shared_ptr<Ship_component>&)>& pred) const {
+    vector<shared_ptr<Ship_component>> ship_vect;
+    for (auto& ship_pair : ships.get_entries()) {
+        if (ship_pair.second && pred(ship_pair.second))
+            ship_vect.push_back(ship_pair.second);
+    }
+    return ship_vect;
+}
+
 // Get a ship's pointer based on the name of the ship.
 shared_ptr<Ship_component> Model::get_ship_ptr(const string& name) const {
-    auto itt = ship_map.find(name);
-    if (itt == ship_map.end())
+    auto ship_ptr = ships.find(name);
+    if (!ship_ptr)
         throw Error("Ship not found!");
-    return itt->second;
+    return ship_ptr;
 }
 
-// Removes a ship from the model.
+// Removes a ship from the model. The ship can no longer be looked up, but while
+// an update is going through the objects its entries are only cleared, and are
+// erased with the others once the objects have all been updated.
 void Model::remove_ship(shared_ptr<Ship_component> ship_ptr) {
-    ship_map.erase(ship_ptr->get_name());
-    object_map.erase(ship_ptr->get_name());
+    ships.erase(ship_ptr->get_name());
+    objects.erase(ship_ptr->get_name());
+    abbreviations.remove(ship_ptr->get_name());
+    update_buckets_valid = false;
+    if (!updating) {
+        ships.compact();
+        objects.compact();
+    }
 }
 
 // Describe all objects in the model in alphabetical order.
 void Model::describe() const {
-    for_each(object_map.begin(), object_map.end(),
-            bind(&Sim_object::describe,
-                    bind(&ObjectMap_t::value_type::second, _1)));
+    for (auto& object_pair : objects.get_entries())
+        object_pair.second->describe();
+}
+
+// Every object is made with make_shared, which puts a block with a virtual
+// function table pointer and the two reference counts in front of the object
+const size_t shared_block_size_c = sizeof(void*) + 2 * sizeof(int);
+
+// Add up the objects by type name, then everything they share
+void Model::describe_memory() const {
+    struct Type_total {
+        int count = 0;
+        size_t size = 0;
+    };
+    map<string, Type_total> type_totals;
+    for (auto& ship_entry : ships.get_entries()) {
+        if (!ship_entry.second)
+            continue;
+        auto& type_total = type_totals[ship_entry.second->get_type_name()];
+        ++type_total.count;
+        type_total.size += ship_entry.second->get_memory_size() + shared_block_size_c;
+    }
+    for (auto& island_entry : islands.get_entries()) {
+        auto& type_total = type_totals["Island"];
+        ++type_total.count;
+        type_total.size += island_entry.second->get_memory_size() + shared_block_size_c;
+    }
+
+    size_t total_size = 0;
+    cout << "Memory use:" << endl;
+    for (auto& type_pair : type_totals) {
+        auto& type_total = type_pair.second;
+        cout << type_pair.first << ": " << type_total.count << " objects, " <<
+                type_total.size << " bytes, " <<
+                static_cast<double>(type_total.size) / type_total.count << " each" << endl;
+        total_size += type_total.size;
+    }
+    size_t names_size = Sim_object::get_names_memory_size();
+    cout << "Names: " << Sim_object::get_name_count() << " names, " <<
+            names_size << " bytes" << endl;
+    size_t parameters_size = get_ship_parameters_memory_size();
+    cout << "Ship parameters: " << get_ship_parameter_block_count() << " blocks, " <<
+            parameters_size << " bytes" << endl;
+    size_t tables_size = objects.get_memory_size() + ships.get_memory_size() +
+            islands.get_memory_size() + island_fuel_table->get_memory_size() +
+            abbreviations.get_memory_size();
+    cout << "Model tables: " << tables_size << " bytes" << endl;
+    total_size += names_size + parameters_size + tables_size;
+    cout << "Total: " << total_size << " bytes" << endl;
 }
 
 // Simulate the next time step by incrementing the time, and updating all objects
-// in the model.
+// in the model. Then the phases scheduled during the tick are run in the order they
+// were scheduled, and objects that scheduled a broadcast during the tick send it.
+// Ships removed during the tick are skipped, and their entries erased at the end.
 void Model::update() {
     time += 1;
-    for_each(object_map.begin(), object_map.end(),
-            bind(&Sim_object::update,
-                    bind(&ObjectMap_t::value_type::second, _1)));
+    updating = true;
+    if (update_by_type) {
+        update_objects_by_type();
+    } else {
+        for (auto& object_pair : objects.get_entries()) {
+            if (object_pair.second)
+                object_pair.second->update();
+        }
+    }
+    vector<function<void()>> phases;
+    phases.swap(update_phases);
+    for (auto& phase : phases)
+        phase();
+    updating = false;
+    ships.compact();
+    objects.compact();
+    send_scheduled_broadcasts();
+    notify_time(time);
+}
+
+// Phases are only run by update()
+void Model::schedule_update_phase(function<void()> task) {
+    update_phases.push_back(move(task));
+}
+
+/*
+ * Snapshot layout:
+ *   magic string, format version, time, whether combat is batched, whether
+ *   objects are updated by type, how fuel is allocated
+ *   ship type count, then the current parameters of each ship type
+ *   island count, then the name of each island
+ *   ship count, then the class name and name of each ship and group
+ *   the saved state of each island, then of each ship and group, in the same order
+ * All objects are listed before any state so that every object exists by the time
+ * references to it are read.
+ */
+
+// Write the snapshot to memory, then to the file in one go
+void Model::save_snapshot(const std::string& file_name) const {
+    Snapshot_writer writer;
+    writer.write_string(snapshot_magic_c);
+    writer.write_int(snapshot_version_c);
+    writer.write_int(time);
+    writer.write_bool(combat_batched);
+    writer.write_bool(update_by_type);
+    writer.write_int(static_cast<int>(fuel_allocation));
+
+    auto ship_types = get_ship_types();
+    writer.write_int(static_cast<int>(ship_types.size()));
+    for (auto parameters : ship_types)
+        save_ship_parameters(writer, *parameters);
+
+    writer.write_int(static_cast<int>(islands.size()));
+    for (auto& island_pair : islands.get_entries())
+        writer.write_string(island_pair.first);
+    writer.write_int(static_cast<int>(ships.size()));
+    for (auto& ship_pair : ships.get_entries()) {
+        writer.write_string(ship_pair.second->get_class_name());
+        writer.write_string(ship_pair.first);
+    }
+
+    for (auto& island_pair : islands.get_entries())
+        island_pair.second->save_state(writer);
+    for (auto& ship_pair : ships.get_entries())
+        ship_pair.second->save_state(writer);
+
+    ofstream file(file_name, ios::binary | ios::trunc);
+    file.write(writer.get_data().data(), writer.get_data().size());
+    if (!file)
+        throw Error("Could not write snapshot file!");
+}
+
+// Build the new world in separate containers straight from the mapped file,
+// and only replace the current one once everything has been read.
+void Model::load_snapshot(const std::string& file_name) {
+    Mapped_file file(file_name);
+    Snapshot_reader reader(file.begin(), file.end());
+    if (reader.read_string() != snapshot_magic_c)
+        throw Error("Invalid snapshot file!");
+    if (reader.read_int() != snapshot_version_c)
+        throw Error("Unsupported snapshot version!");
+    int new_time = reader.read_int();
+    bool new_combat_batched = reader.read_bool();
+    bool new_update_by_type = reader.read_bool();
+    int new_fuel_allocation = reader.read_int();
+    if (new_fuel_allocation < static_cast<int>(Fuel_allocation_t::immediate) ||
+            new_fuel_allocation > static_cast<int>(Fuel_allocation_t::pro_rata))
+        throw Error("Invalid snapshot file!");
+
+    // The ship types are only defined once the whole snapshot has been read, so
+    // a bad snapshot leaves the registry as it was. Ships are made as their class
+    // and restore their own parameters, so they don't need the types. Any types
+    // defined since the snapshot was saved stay defined.
+    vector<Ship_parameters> new_ship_types;
+    int ship_type_count = reader.read_int();
+    for (int i = 0; i < ship_type_count; ++i) {
+        Ship_parameters parameters = restore_ship_parameters(reader);
+        if (!find_class_parameters(parameters.class_name) || !has_valid_values(parameters))
+            throw Error("Invalid snapshot file!");
+        new_ship_types.push_back(parameters);
+    }
+
+    Name_table<Sim_object> new_objects;
+    Ships_t new_ships;
+    Islands_t new_islands;
+    unique_ptr<Island_fuel_table> new_island_fuel_table(new Island_fuel_table);
+    Abbreviation_index new_abbreviations;
+    // Objects in the order their state was saved
+    vector<shared_ptr<Sim_object>> saved_objects;
+
+    // Any duplicate names are rejected before they are added to the tables
+    auto check_new_name = [&new_objects](const string& name) {
+        if (new_objects.contains(name))
+            throw Error("Invalid snapshot file!");
+    };
+    int island_count = reader.read_int();
+    for (int i = 0; i < island_count; ++i) {
+        string name = reader.read_string();
+        check_new_name(name);
+        auto island_ptr = make_shared<Island>(name, Point(), *new_island_fuel_table);
+        new_islands.insert(island_ptr);
+        new_objects.insert(island_ptr);
+        new_abbreviations.add(name);
+        saved_objects.push_back(island_ptr);
+    }
+    int ship_count = reader.read_int();
+    for (int i = 0; i < ship_count; ++i) {
+        string class_name = reader.read_string();
+        string name = reader.read_string();
+        check_new_name(name);
+        auto ship_ptr = create_ship_of_class(name, class_name);
+        if (!ship_ptr)
+            throw Error("Invalid snapshot file!");
+        new_ships.insert(ship_ptr);
+        new_objects.insert(ship_ptr);
+        new_abbreviations.add(name);
+        saved_objects.push_back(ship_ptr);
+    }
+
+    reader.set_lookups(
+            [&new_islands](const string& name) { return new_islands.find(name); },
+            [&new_ships](const string& name) { return new_ships.find(name); });
+    for (auto& object_ptr : saved_objects)
+        object_ptr->restore_state(reader);
+    if (!reader.at_end())
+        throw Error("Invalid snapshot file!");
+    for (auto& parameters : new_ship_types)
+        define_ship_type(parameters);
+
+    // Tell the views about objects that no longer exist, then switch worlds
+    for (auto& object_pair : objects.get_entries()) {
+        if (!new_objects.contains(object_pair.first))
+            notify_gone(object_pair.first);
+    }
+    objects.swap(new_objects);
+    ships.swap(new_ships);
+    islands.swap(new_islands);
+    island_fuel_table.swap(new_island_fuel_table);
+    abbreviations.swap(new_abbreviations);
+    time = new_time;
+    combat_batched = new_combat_batched;
+    update_by_type = new_update_by_type;
+    fuel_allocation = static_cast<Fuel_allocation_t>(new_fuel_allocation);
+    update_buckets_valid = false;
+    producing_islands_valid = false;
+    for (auto& object_pair : objects.get_entries())
+        object_pair.second->broadcast_current_state();
+}
+
+// The branch runs in a forked child process, which shares every page of the world
+// with this process until one of them writes to it. The child writes its output
+// straight to our cout and leaves without running any destructors.
+void Model::run_branch(int ticks, const function<void()>& branch_setup) {
+    // Don't let the child repeat anything still waiting to be written
+    cout.flush();
+    pid_t pid = fork();
+    if (pid < 0)
+        throw Error("Could not fork the simulation!");
+    if (pid == 0) {
+        cout << "Branch started at time " << time << endl;
+        try {
+            branch_setup();
+            for (int i = 0; i < ticks; ++i)
+                update();
+            cout << "Branch at time " << time << ":";
+            describe();
+        } catch (Error& e) {
+            cout << e.what() << endl;
+        } catch (exception& e) {
+            cout << e.what() << endl;
+        }
+        cout.flush();
+        _exit(0);
+    }
+
+    int status;
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status))
+        throw Error("Branch terminated abnormally!");
+    cout << "Branch discarded, back at time " << time << endl;
 }
 
 // Attach a view to the model, and tell all objects to broadcast their state
 // so the view can be populated with data.
 void Model::attach(shared_ptr<View> view) {
     view_set.insert(view);
-    for_each(object_map.begin(), object_map.end(),
-            bind(&Sim_object::broadcast_current_state,
-                    bind(&ObjectMap_t::value_type::second, _1)));
+    for (auto& object_pair : objects.get_entries())
+        object_pair.second->broadcast_current_state();
 }
 
 // Detach a view from the model.
@@ -125,36 +405,97 @@ void Model::detach(shared_ptr<View> view) {
     view_set.erase(view);
 }
 
+// Each notification is saved instead of sent while the calling thread has a
+// notification queue.
+
 // Notify views of an object's location.
 void Model::notify_location(const std::string& name, Point location) {
+    if (notification_queue) {
+        queue_notification(bind(&Model::notify_location, this, name, location));
+        return;
+    }
     for_each(view_set.begin(), view_set.end(),
             bind(&View::update_location, _1, name, location));
 }
 
 // Notify views of an object's course.
 void Model::notify_course(const std::string& name, double course) {
+    if (notification_queue) {
+        queue_notification(bind(&Model::notify_course, this, name, course));
+        return;
+    }
     for_each(view_set.begin(), view_set.end(),
             bind(&View::update_course, _1, name, course));
 }
 
 // Notify views of an object's speed.
 void Model::notify_speed(const std::string& name, double speed) {
+    if (notification_queue) {
+        queue_notification(bind(&Model::notify_speed, this, name, speed));
+        return;
+    }
     for_each(view_set.begin(), view_set.end(),
             bind(&View::update_speed, _1, name, speed));
 }
 
 // Notify views of an object's fuel.
 void Model::notify_fuel(const std::string& name, double fuel) {
+    if (notification_queue) {
+        queue_notification(bind(&Model::notify_fuel, this, name, fuel));
+        return;
+    }
     for_each(view_set.begin(), view_set.end(),
             bind(&View::update_fuel, _1, name, fuel));
 }
 
+// Notify views of a group's summary.
+void Model::notify_group(const std::string& name, const Group_summary& summary) {
+    if (notification_queue) {
+        queue_notification(bind(&Model::notify_group, this, name, summary));
+        return;
+    }
+    for_each(view_set.begin(), view_set.end(),
+            bind(&View::update_group, _1, name, summary));
+}
+
+// Notify views that the update for time_ is finished
+void Model::notify_time(int time_) {
+    if (notification_queue) {
+        queue_notification(bind(&Model::notify_time, this, time_));
+        return;
+    }
+    for_each(view_set.begin(), view_set.end(),
+            bind(&View::update_time, _1, time_));
+}
+
 // Notify views that an object is no longer in the simulation
 void Model::notify_gone(const std::string& name) {
+    if (notification_queue) {
+        queue_notification(bind(&Model::notify_gone, this, name));
+        return;
+    }
     for_each(view_set.begin(), view_set.end(),
             bind(&View::update_remove, _1, name));
 }
 
+// Objects are responsible for scheduling themselves only once until they broadcast
+void Model::schedule_broadcast(shared_ptr<Sim_object> object_ptr) {
+    scheduled_broadcasts.push_back(object_ptr);
+}
+
+// An object that has been removed from the Model must not be added back to the views
+void Model::send_scheduled_broadcasts() {
+    vector<weak_ptr<Sim_object>> broadcasts;
+    broadcasts.swap(scheduled_broadcasts);
+    for (auto& object_weak_ptr : broadcasts) {
+        auto object_ptr = object_weak_ptr.lock();
+        if (!object_ptr)
+            continue;
+        if (objects.find(object_ptr->get_name()) == object_ptr)
+            object_ptr->broadcast_current_state();
+    }
+}
+
 // Get the singleton pointer for the Model, create the singleton if it has not
 // yet been created.
 Model *Model::get_inst() {
@@ -166,15 +507,52 @@ Model *Model::get_inst() {
 /* Private member functions */
 // Add an island to relevant data structures
 void Model::insert_island(shared_ptr<Island> island) {
-    island_map.insert({island->get_name(), island});
-    object_map.insert({island->get_name(), island});
+    islands.insert(island);
+    objects.insert(island);
+    abbreviations.add(island->get_name());
+    producing_islands_valid = false;
 }
 
 // Add a ship to relevant data structures
 void Model::insert_ship(shared_ptr<Ship_component> ship_ptr) {
     assert(!is_name_in_use(ship_ptr->get_name()));
-    ship_map.insert({ship_ptr->get_name(), ship_ptr});
-    object_map.insert({ship_ptr->get_name(), ship_ptr});
+    ships.insert(ship_ptr);
+    objects.insert(ship_ptr);
+    abbreviations.add(ship_ptr->get_name());
+    update_buckets_valid = false;
+}
+
+// Islands can't be removed, so they are always all there, and every island in
+// the fuel table is one of them. The ship entries are
+// only cleared during the update, so the indices in the buckets stay good.
+void Model::update_objects_by_type() {
+    if (!producing_islands_valid) {
+        producing_islands.clear();
+        for (auto& island_pair : islands.get_entries()) {
+            if (island_pair.second->is_producing())
+                producing_islands.push_back(island_pair.second.get());
+        }
+        producing_islands_valid = true;
+    }
+    Island::update_producing(*island_fuel_table, producing_islands);
+
+    const Ship_entries_t& ship_entries = ships.get_entries();
+    if (!update_buckets_valid) {
+        update_buckets.clear();
+        for (size_t i = 0; i < ship_entries.size(); ++i) {
+            Ship_update_fn_t update_fn =
+                    get_ship_update_fn(ship_entries[i].second->get_class_name());
+            assert(update_fn);
+            auto bucket_it = find_if(update_buckets.begin(), update_buckets.end(),
+                    [update_fn](const Update_bucket& bucket) { return bucket.update_fn == update_fn; });
+            if (bucket_it == update_buckets.end())
+                bucket_it = update_buckets.insert(update_buckets.end(), {update_fn, {}});
+            bucket_it->indices.push_back(i);
+        }
+        update_buckets_valid = true;
+    }
+    for (auto& bucket : update_buckets)
+        bucket.update_fn(ship_entries, bucket.indices);
 }
 
 /******* Model_destroyer ********/
@@ -3,12 +3,17 @@
 
 #include "Geometry.h"
 #include "Navigation.h"
+#include "Group_summary.h"
+#include "Name_table.h"
+#include "Abbreviation_index.h"
+#include "Ship_factory.h"
+#include "Island_fuel_table.h"
 
 #include <string>
 #include <set>
-#include <map>
 #include <memory>
 #include <vector>
+#include <functional>
 
 /*
 Model is part of a simplified Model-View-Controller pattern.
@@ -36,7 +41,8 @@ public:
     int get_time() { return time; }
 
     // is name already in use for either ship or island?
-    // either the identical name, or identical in first two characters counts as in-use
+    // either the identical name, or identical in first two characters counts as in-use.
+    // Takes constant time and doesn't allocate.
     bool is_name_in_use(const std::string &name) const;
 
     // is there such an island?
@@ -54,18 +60,86 @@ public:
     // add a new ship to the model, and updates the views
     void add_ship(std::shared_ptr<Ship_component> ship);
 
+    // return the ship with that name, or nullptr if there is none
+    std::shared_ptr<Ship_component> find_ship_ptr(const std::string& name) const;
+
+    // Get vector of the ships and groups for which pred returns true, sorted by name
+    std::vector<std::shared_ptr<Ship_component>> get_vector_of_ships_if(
+            const std::function<bool (const std::shared_ptr<Ship_component>&)>& pred) const;
+
     // will throw Error("Ship not found!") if no ship of that name
     std::shared_ptr<Ship_component> get_ship_ptr(const std::string& name) const;
 
-    // remove a Ship from the model.
+    // remove a Ship from the model. Ships can be removed while the Model is
+    // updating its objects, and are not updated after they have been removed.
     void remove_ship(std::shared_ptr<Ship_component> ship_ptr);
 
     // tell all objects to describe themselves
     void describe() const;
 
+    // Output the bytes used by the objects of each type, by the tables of names
+    // and ship parameters that they share, and by the Model's own tables
+    void describe_memory() const;
+
     // increment the time, and tell all objects to update themselves
     void update();
 
+    // Have task run once in the current update after every object has updated,
+    // before scheduled broadcasts are sent. Used by objects whose interactions
+    // with each other are resolved all at once, such as combat.
+    void schedule_update_phase(std::function<void()> task);
+
+    // If true, warships fire during their update but the hits are resolved together
+    // at the end of the update, see Warship.h. Saved with the snapshot.
+    bool is_combat_batched() const { return combat_batched; }
+    void set_combat_batched(bool combat_batched_) { combat_batched = combat_batched_; }
+
+    // If true, update() goes through the objects a type at a time instead of in
+    // name order: first the islands, then the ships of each class, each in name
+    // order, calling each class's update function directly instead of through the
+    // virtual function. Every island's fuel is produced in one pass over the
+    // island fuel table, and the messages of the producing islands are output
+    // together. Objects interact as they update, such as tankers loading from
+    // islands and warships firing, so only name order gives the same results and
+    // output as before; it is the default, and in it each island is still updated
+    // through update() in its place among the ships, which may draw on its fuel
+    // before or after it produces. Saved with the snapshot.
+    bool is_updating_by_type() const { return update_by_type; }
+    void set_update_by_type(bool update_by_type_) { update_by_type = update_by_type_; }
+
+    // How the fuel that ships ask islands for during an update is shared out, see
+    // Island.h. With immediate allocation, the default, each request is served
+    // when it is made. Saved with the snapshot.
+    enum class Fuel_allocation_t { immediate, fifo, pro_rata };
+    Fuel_allocation_t get_fuel_allocation() const { return fuel_allocation; }
+    void set_fuel_allocation(Fuel_allocation_t fuel_allocation_)
+        { fuel_allocation = fuel_allocation_; }
+
+    // Return true while update() is going through the objects and running the
+    // phases
+    bool is_updating() const { return updating; }
+
+    /* Snapshot services */
+    // Write the state of every object and the time to a binary snapshot file.
+    // may throw Error("Could not write snapshot file!")
+    void save_snapshot(const std::string& file_name) const;
+
+    // Replace the state of the simulation with the contents of a snapshot file.
+    // Views are told about objects that are gone and get the state of every
+    // loaded object. The simulation is unchanged if the snapshot can't be loaded.
+    // may throw Error("Could not open snapshot file!"), Error("Invalid snapshot file!"),
+    // or Error("Unsupported snapshot version!")
+    void load_snapshot(const std::string& file_name);
+
+    /* What-if branches */
+    // Run a branch of the simulation in a copy-on-write clone of the world: call
+    // branch_setup in the clone, advance the clone by ticks, have it describe itself,
+    // and throw it away. The clone only copies the memory it changes, so branching
+    // a large world is cheap. This Model and its Views are not affected.
+    // may throw Error("Could not fork the simulation!") or
+    // Error("Branch terminated abnormally!")
+    void run_branch(int ticks, const std::function<void()>& branch_setup);
+
     /* View services */
     // Attaching a View adds it to the container and causes it to be updated
     // with all current objects'location (or other state information.
@@ -87,9 +161,42 @@ public:
     // notify the views about a ship's fuel
     void notify_fuel(const std::string& name, double fuel);
 
+    // notify the views about the summary of a group's ships
+    void notify_group(const std::string& name, const Group_summary& summary);
+
+    // notify the views that an update of the simulation has finished
+    void notify_time(int time_);
+
     // notify the views that an object is now gone
     void notify_gone(const std::string &name);
 
+    // Have the object broadcast its state the next time scheduled broadcasts are
+    // sent, which is at the end of each update and before views are drawn. Used
+    // by objects whose state changes too often to broadcast every change.
+    void schedule_broadcast(std::shared_ptr<Sim_object> object_ptr);
+
+    // Have every object that is still in the Model and scheduled a broadcast
+    // broadcast its current state
+    void send_scheduled_broadcasts();
+
+    // Notifications saved to be sent to the views later
+    using Notification_queue_t = std::vector<std::function<void()>>;
+
+    // While a queue is set, the notifications made by the calling thread are added
+    // to it instead of being sent. Views are not thread safe, so threads that
+    // change ships in parallel save their notifications for one thread to send.
+    // Set to nullptr to send notifications directly again.
+    static void set_notification_queue(Notification_queue_t* queue)
+        { notification_queue = queue; }
+
+    // Return true if the calling thread has a queue for its notifications
+    static bool is_queueing_notifications()
+        { return notification_queue != nullptr; }
+
+    // Add a notification to the calling thread's queue
+    static void queue_notification(std::function<void()> notification)
+        { notification_queue->push_back(std::move(notification)); }
+
     // get model pointer singleton instance
     static Model *get_inst();
 
@@ -109,18 +216,51 @@ private:
     // Pointer to the singleton Model object.
     static Model *singleton_ptr;
 
+    // The calling thread's queue of saved notifications, if any
+    static thread_local Notification_queue_t* notification_queue;
+
     int time = 0;        // the simulated time
+    bool combat_batched = false;
+    bool update_by_type = false;
+    Fuel_allocation_t fuel_allocation = Fuel_allocation_t::immediate;
 
     // Alias the data containers to some more meaningful names.
-    using ObjectMap_t = std::map<std::string, std::shared_ptr<Sim_object>>;
-    using ShipMap_t = std::map<std::string, std::shared_ptr<Ship_component>>;
-    using IslandMap_t = std::map<std::string, std::shared_ptr<Island>>;
+    using Ships_t = Name_table<Ship_component>;
+    using Islands_t = Name_table<Island>;
     using ViewSet_t = std::set<std::shared_ptr<View>>;
 
-    ObjectMap_t object_map; // Map of all object pointers, key is the object's name
-    ShipMap_t ship_map; // Map of ship pointers , key is the ship's name
-    IslandMap_t island_map; // Map of island pointers, key is the island's name
+    // The objects are kept in name order, see Name_table.h
+    Name_table<Sim_object> objects; // All objects, islands and ships
+    Ships_t ships; // Ships and groups
+    Islands_t islands;
+    // The fuel and production rate of every island, see Island_fuel_table.h.
+    // The islands of a world loaded from a snapshot get a new table.
+    std::unique_ptr<Island_fuel_table> island_fuel_table;
+    Abbreviation_index abbreviations; // The abbreviations of all of the objects' names
     ViewSet_t view_set; // Set of view pointers
+    std::vector<std::weak_ptr<Sim_object>> scheduled_broadcasts;
+    std::vector<std::function<void()>> update_phases;
+    // True while update() is going through the objects and running the phases.
+    // Ships removed meanwhile leave cleared entries in the tables, which are
+    // erased at the end of the update.
+    bool updating = false;
+
+    // The indices in ships of the ships of each class, in order of the first ship
+    // of the class, built again when ships are added or removed
+    struct Update_bucket {
+        Ship_update_fn_t update_fn;
+        std::vector<std::size_t> indices;
+    };
+    std::vector<Update_bucket> update_buckets;
+    bool update_buckets_valid = false;
+
+    // The islands that produce fuel, in name order, for their messages, built
+    // again when islands are added
+    std::vector<Island*> producing_islands;
+    bool producing_islands_valid = false;
+
+    // Update the producing islands, then each bucket of ships
+    void update_objects_by_type();
 
     // Insert an island to relevant containers
     void insert_island(std::shared_ptr<Island> island);
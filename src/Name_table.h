@@ -0,0 +1,143 @@
+#ifndef NAME_TABLE_H
+#define NAME_TABLE_H
+
+#include "Utility.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <algorithm>
+#include <utility>
+#include <cassert>
+
+/* Name_table
+ *
+ * A container of named objects, held by shared_ptr, that is kept in name order in
+ * a single vector so that going through all of the objects is a linear scan over
+ * contiguous memory. A hash index from the names finds an object in constant time.
+ * T must have a get_name() member function, and the names must be unique.
+ *
+ * New objects are added to the end of the vector, and are only merged into their
+ * place the next time the objects are needed in order, so adding many objects in
+ * a row does not move the others each time.
+ *
+ * Removing an object takes it out of the index at once, but only clears its entry
+ * in the vector, which keeps the name. A cleared entry has a null pointer, so
+ * code going through the objects must skip them. compact() erases the cleared
+ * entries in one pass; until then, the entries of the other objects stay where
+ * they are, so objects can be removed while the table is being gone through, but
+ * not added.
+ */
+
+template <typename T>
+class Name_table {
+public:
+    using Ptr_t = std::shared_ptr<T>;
+    using Entry_t = std::pair<std::string, Ptr_t>;
+    using Entries_t = std::vector<Entry_t>;
+
+    // Add an object, whose name must not already be in the table. The cleared
+    // entries are erased first, so no name is in the vector twice.
+    void insert(Ptr_t ptr) {
+        compact();
+        bool inserted = index.emplace(ptr->get_name(), ptr).second;
+        assert(inserted);
+        (void)inserted;
+        entries.emplace_back(ptr->get_name(), std::move(ptr));
+    }
+
+    // Return the object with name, or nullptr if there is none
+    Ptr_t find(const std::string& name) const {
+        auto itt = index.find(name);
+        return itt == index.end() ? nullptr : itt->second;
+    }
+
+    bool contains(const std::string& name) const
+        { return index.find(name) != index.end(); }
+
+    // Remove the object with name, if there is one, leaving a cleared entry
+    void erase(const std::string& name) {
+        if (!index.erase(name))
+            return;
+        auto itt = find_entry(name);
+        assert(itt != entries.end());
+        itt->second.reset();
+        ++cleared_count;
+    }
+
+    // Erase the cleared entries, putting the new ones in order first
+    void compact() {
+        if (!cleared_count)
+            return;
+        sort_new_entries();
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                [](const Entry_t& entry) { return !entry.second; }), entries.end());
+        sorted_count = entries.size();
+        cleared_count = 0;
+    }
+
+    // Return the entries in name order, including any cleared ones
+    const Entries_t& get_entries() const {
+        sort_new_entries();
+        return entries;
+    }
+
+    // Number of objects, not counting the cleared entries
+    std::size_t size() const { return index.size(); }
+
+    // Bytes used by the vector and the index, including the names they hold but
+    // not the objects
+    std::size_t get_memory_size() const {
+        std::size_t size = entries.capacity() * sizeof(Entry_t) +
+                get_hash_table_memory_size(index);
+        for (auto& entry : entries)
+            size += get_string_memory_size(entry.first);
+        for (auto& index_pair : index)
+            size += get_string_memory_size(index_pair.first);
+        return size;
+    }
+
+    void swap(Name_table& other) {
+        entries.swap(other.entries);
+        index.swap(other.index);
+        std::swap(sorted_count, other.sorted_count);
+        std::swap(cleared_count, other.cleared_count);
+    }
+
+private:
+    // Entries before sorted_count are in name order, the rest are new
+    mutable Entries_t entries;
+    mutable std::size_t sorted_count = 0;
+    std::size_t cleared_count = 0;
+    std::unordered_map<std::string, Ptr_t> index;
+
+    static bool name_less(const Entry_t& entry, const std::string& name)
+        { return entry.first < name; }
+
+    // Sort the new entries and merge them in with the others. Cleared entries keep
+    // their names, so they stay in order.
+    void sort_new_entries() const {
+        if (sorted_count == entries.size())
+            return;
+        auto by_name = [](const Entry_t& lhs, const Entry_t& rhs)
+            { return lhs.first < rhs.first; };
+        std::sort(entries.begin() + sorted_count, entries.end(), by_name);
+        std::inplace_merge(entries.begin(), entries.begin() + sorted_count, entries.end(),
+                by_name);
+        sorted_count = entries.size();
+    }
+
+    // Return the entry for name, looking through the new entries if it isn't
+    // with the sorted ones
+    typename Entries_t::iterator find_entry(const std::string& name) {
+        auto sorted_end = entries.begin() + sorted_count;
+        auto itt = std::lower_bound(entries.begin(), sorted_end, name, name_less);
+        if (itt != sorted_end && itt->first == name)
+            return itt;
+        return std::find_if(sorted_end, entries.end(),
+                [&name](const Entry_t& entry) { return entry.first == name; });
+    }
+};
+
+#endif
@@ -9,6 +9,7 @@ See Navigation.h for comments
 #include <iostream>
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 
 using namespace std;
 
@@ -176,6 +177,12 @@ ostream& operator<< (ostream& os, const Compass_vector& cv)
 
 // *** Other navigation functions  ***
 
+// Return the velocity for a Course_speed, the displacement from one hour of travel
+Cartesian_vector to_Cartesian_vector(const Course_speed& cs)
+{
+	return Cartesian_vector(Polar_vector(cs.speed, to_radians(to_other_degrees(cs.course))));
+}
+
 // *** compute_CPA ***
 // Given ownship's course and speed, and the target's course and speed, and bearing and range from ownship,
 // compute the range and bearing of the point of closest approach and the time until the point.
@@ -186,8 +193,8 @@ Compass_position compute_CPA(Course_speed ownship_cs, Course_speed target_cs, Co
 {
 	
 	// convert the two courses and speeds to Cartesian vectors
-	Cartesian_vector ownship_cv(Polar_vector(ownship_cs.speed, to_radians(to_other_degrees (ownship_cs.course))));
-	Cartesian_vector target_cv(Polar_vector(target_cs.speed, to_radians(to_other_degrees (target_cs.course))));
+	Cartesian_vector ownship_cv = to_Cartesian_vector(ownship_cs);
+	Cartesian_vector target_cv = to_Cartesian_vector(target_cs);
 	// compute a vector for the position of the target right now (time = 0) relative to ownship.
 	Cartesian_vector relative_target_position(to_Polar_vector(target_position_cp));
 	
@@ -219,5 +226,39 @@ Compass_position compute_CPA(Course_speed ownship_cs, Course_speed target_cs, Co
 		}
 }
 
+// *** compute_CPAs ***
+// The same computation as compute_CPA, done in cartesian form for all of the pairs at
+// once. The loop for the ranges and times has no branches and works on flat arrays,
+// so the compiler can turn it into SIMD instructions (GCC does at -O3 when it is
+// allowed to ignore floating point traps, -fno-trapping-math). The bearings need
+// atan2, which can't be vectorized, so they are computed in a separate loop.
 
-
+void compute_CPAs(int count, const double* relative_x, const double* relative_y,
+	const double* relative_x_velocity, const double* relative_y_velocity, double time_limit,
+	double* cpa_ranges, double* cpa_bearings, double* times_to_CPA)
+{
+	for (int i = 0; i < count; i++) {
+		double dx = relative_x[i];
+		double dy = relative_y[i];
+		double dvx = relative_x_velocity[i];
+		double dvy = relative_y_velocity[i];
+		double speed_square = dvx * dvx + dvy * dvy;
+		// the time of closest approach; if the target is not moving relative to us
+		// the dot product is zero, and dividing it by one gives a time of zero
+		double t = -(dx * dvx + dy * dvy) / (speed_square > 0. ? speed_square : 1.);
+		t = min(max(t, 0.), time_limit);
+		double cpa_x = dx + dvx * t;
+		double cpa_y = dy + dvy * t;
+		times_to_CPA[i] = t;
+		cpa_ranges[i] = sqrt(cpa_x * cpa_x + cpa_y * cpa_y);
+	}
+	if (!cpa_bearings)
+		return;
+
+	for (int i = 0; i < count; i++) {
+		double t = times_to_CPA[i];
+		double cpa_x = relative_x[i] + relative_x_velocity[i] * t;
+		double cpa_y = relative_y[i] + relative_y_velocity[i] * t;
+		cpa_bearings[i] = Compass_position(Polar_vector(Cartesian_vector(cpa_x, cpa_y))).bearing;
+	}
+}
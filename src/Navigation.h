@@ -58,12 +58,19 @@ To determine where a track will be, add its current Point and
 the Compass_vector for its course and the time to get its new Point:
 	current_track_position + track_compass_vector => new_track_position
 
+Compass degrees are meant for input and output. Computations that are repeated inside
+the simulation, such as moving a track every time step, can instead convert a 
+Course_speed once to a velocity, the Cartesian_vector that it moves in one hour, 
+and work with Points and Cartesian_vectors from then on:
+	current_track_position + track_velocity * time => new_track_position
+
 */
 
 #include <iosfwd>
 
 // forward declarations
 struct Point;
+struct Cartesian_vector;
 struct Polar_vector;
 struct Course_speed;
 struct Compass_position;
@@ -143,10 +150,25 @@ std::ostream& operator<< (std::ostream& os, const Compass_vector& cv);
 
 // *** Other navigation functions  ***
 
+// Return the velocity for a Course_speed, the displacement from one hour of travel
+Cartesian_vector to_Cartesian_vector(const Course_speed& cs);
+
 // Given ownship's course and speed, and the target's course and speed, and bearing and range from ownship,
 // compute the range and bearing of the point of closest approach and the time until the point.
 // If the CPA is the current position, it is returned with the time being zero.
 Compass_position compute_CPA(Course_speed ownship_cs, Course_speed target_cs, Compass_position target_position_cp, double& time_to_CPA);
 
+// Batch version of compute_CPA for count ownship/target pairs, given in cartesian form.
+// For pair i, the target's position relative to ownship is (relative_x[i], relative_y[i]) nm
+// and its velocity relative to ownship is (relative_x_velocity[i], relative_y_velocity[i]) nm/hr.
+// The range and bearing of the CPA from ownship and the time until it are stored in
+// cpa_ranges[i], cpa_bearings[i], and times_to_CPA[i]; they agree with compute_CPA to
+// within rounding. The CPA is only looked for up to time_limit hours ahead - pass infinity
+// for no limit. A target with no relative motion has its CPA at its current position.
+// cpa_bearings may be null to skip computing the bearings, which is the slow part.
+void compute_CPAs(int count, const double* relative_x, const double* relative_y,
+	const double* relative_x_velocity, const double* relative_y_velocity, double time_limit,
+	double* cpa_ranges, double* cpa_bearings, double* times_to_CPA);
+
 
 #endif
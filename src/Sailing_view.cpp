@@ -22,9 +22,15 @@ void Sailing_view::update_fuel(const string& name, double fuel) {
     sailing_data_map[name].fuel = fuel;
 }
 
-// Remove a ship from the data structure
+// Update the summary of a group in the data structure
+void Sailing_view::update_group(const string& name, const Group_summary& summary) {
+    group_data_map[name] = summary;
+}
+
+// Remove a ship or group from the data structures
 void Sailing_view::update_remove(const string& name) {
     sailing_data_map.erase(name);
+    group_data_map.erase(name);
 }
 
 // Draw the sailing statistics of all ships on the ocean
@@ -45,5 +51,26 @@ void Sailing_view::draw() const {
         setw(sailing_column_width_c) << sailing_data.speed <<
         endl;
     }
+
+    if (group_data_map.empty())
+        return;
+    // Print the groups with the fuel and position of their ships
+    cout << setw(sailing_column_width_c) << "Group" <<
+    setw(sailing_column_width_c) << "Ships" <<
+    setw(sailing_column_width_c) << "Fuel" <<
+    setw(sailing_column_width_c) << "Min fuel" <<
+    setw(sailing_column_width_c) << "Center x" <<
+    setw(sailing_column_width_c) << "Center y" << endl;
+    for (auto& group_pair : group_data_map) {
+        const Group_summary& summary = group_pair.second;
+        cout << setw(sailing_column_width_c) << group_pair.first <<
+        setw(sailing_column_width_c) << summary.ship_count;
+        if (summary.ship_count > 0)
+            cout << setw(sailing_column_width_c) << summary.total_fuel <<
+            setw(sailing_column_width_c) << summary.min_fuel <<
+            setw(sailing_column_width_c) << summary.centroid.x <<
+            setw(sailing_column_width_c) << summary.centroid.y;
+        cout << endl;
+    }
 }
 
@@ -2,14 +2,16 @@
 #define SAILING_VIEW_H
 
 #include "View.h"
+#include "Group_summary.h"
 
 #include <map>
 
-/* Stores the course, speed, and fuel information of the ships of the simulation.
+/* Stores the course, speed, and fuel information of the ships of the simulation,
+ * and the summary of each group.
  *
  * The draw() function prints out that stored informtation to the user to use.
  *
- * Listens to the course, speed, and fuel information feeds.
+ * Listens to the course, speed, fuel, and group information feeds.
  */
 
 class Sailing_view : public View {
@@ -23,7 +25,10 @@ public:
     // Store the fuel information of a ship
     void update_fuel(const std::string& name, double fuel) override;
 
-    // Remove the information of a ship
+    // Store the summary of a group
+    void update_group(const std::string& name, const Group_summary& summary) override;
+
+    // Remove the information of a ship or group
     void update_remove(const std::string& name) override;
 
     // Print out the course, speed, and fuel information of all ships to the user
@@ -39,6 +44,9 @@ private:
 
     // Map of ship names to their sailing data
     std::map<std::string, SailingData> sailing_data_map;
+
+    // Map of group names to their summaries
+    std::map<std::string, Group_summary> group_data_map;
 };
 
 #endif
\ No newline at end of file
@@ -1,7 +1,10 @@
 #include "Ship.h"
 
+#include "Formation.h"
 #include "Island.h"
 #include "Model.h"
+#include "Ship_group.h"
+#include "Snapshot.h"
 #include "Utility.h"
 
 #include <iostream>
@@ -43,9 +46,10 @@ bool Ship::is_afloat() const {
 // Return true if we are within range to dock at the provided island
 bool Ship::can_dock(std::shared_ptr<Island> island_ptr) const {
     assert(island_ptr);
-    double dist_to_island =
-            cartesian_distance(island_ptr->get_location(), get_location());
-    return ship_state == State_t::stopped && dist_to_island <= ship_dock_distance_c;
+    double dist_squared_to_island =
+            cartesian_distance_squared(island_ptr->get_location(), get_location());
+    return ship_state == State_t::stopped &&
+            dist_squared_to_island <= ship_dock_distance_c * ship_dock_distance_c;
 }
 
 // Update the state of the ship, simulating a single time step
@@ -98,6 +102,44 @@ void Ship::broadcast_current_state() const {
     Model::get_inst()->notify_fuel(get_name(), fuel);
 }
 
+// Only the formation place is owned by the ship alone
+size_t Ship::get_memory_size() const {
+    return formation_place ? sizeof(Formation_place) : 0;
+}
+
+// Save the state of the ship
+void Ship::save_state(Snapshot_writer& writer) const {
+    save_ship_parameters(writer, *parameters);
+    writer.write_double(fuel);
+    writer.write_point(destination_point);
+    writer.write_island(docked_Island);
+    writer.write_island(destination_Island);
+    writer.write_int(static_cast<int>(ship_state));
+    writer.write_int(resistance);
+    writer.write_point(track_base.get_position());
+    writer.write_double(track_base.get_course());
+    writer.write_double(track_base.get_speed());
+}
+
+// Restore the state of the ship, the Model broadcasts it once everything is loaded.
+// The ship was made as its class, so the saved parameters must be of that class.
+void Ship::restore_state(Snapshot_reader& reader) {
+    Ship_parameters saved_parameters = restore_ship_parameters(reader);
+    if (!has_valid_values(saved_parameters) ||
+            saved_parameters.class_name != parameters->class_name)
+        throw Error("Invalid snapshot file!");
+    parameters = intern_ship_parameters(saved_parameters);
+    fuel = reader.read_double();
+    destination_point = reader.read_point();
+    docked_Island = reader.read_island();
+    destination_Island = reader.read_island();
+    ship_state = static_cast<State_t>(reader.read_int());
+    resistance = reader.read_int();
+    track_base.set_position(reader.read_point());
+    track_base.set_course(reader.read_double());
+    track_base.set_speed(reader.read_double());
+}
+
 /*** Command functions ***/
 
 // Tell the ship to travel to a position at a speed
@@ -169,26 +211,40 @@ void Ship::dock(shared_ptr<Island> island_ptr) {
 void Ship::refuel() {
     if (!is_docked())
         throw Error("Must be docked!");
-    double needed_fuel = fuel_capacity - fuel;
+    double needed_fuel = parameters->fuel_capacity - fuel;
     if (needed_fuel < double_close_enough_c) {
-        set_fuel(fuel_capacity);
+        set_fuel(parameters->fuel_capacity);
         return;
     }
-    set_fuel(fuel + get_docked_Island()->provide_fuel(needed_fuel));
-    cout << get_name() << " now has " << fuel << " tons of fuel" << endl;
+    auto this_ship_ptr = static_pointer_cast<Ship>(shared_from_this());
+    get_docked_Island()->request_fuel(this_ship_ptr, needed_fuel,
+            [this_ship_ptr](double amount) {
+                this_ship_ptr->set_fuel(this_ship_ptr->fuel + amount);
+                cout << this_ship_ptr->get_name() << " now has " <<
+                        this_ship_ptr->fuel << " tons of fuel" << endl;
+            });
 }
 
 // Take a hit from a ship, which can sink us if our resistance goes below 0.
-// We don't care about who attacked us, but functions that override this
-// function might.
-void Ship::receive_hit(int hit_force, shared_ptr<Ship_component>) {
+// Each step can be overridden, derived ships react to the attacker.
+void Ship::receive_hit(int hit_force, shared_ptr<Ship_component> attacker_ptr) {
+    take_hit(hit_force);
+    check_sinking();
+    if (is_afloat())
+        react_to_hit(attacker_ptr);
+}
+
+// Take the hit
+void Ship::take_hit(int hit_force) {
     // We should never be getting hit if we are sunk
     assert(ship_state != State_t::sunk);
-    // Take the hit
     resistance -= hit_force;
     cout << get_name() << " hit with " << hit_force << ", resistance now " <<
     resistance << endl;
-    // If we have negative resistance, sink the ship
+}
+
+// If we have negative resistance, sink the ship
+void Ship::check_sinking() {
     if (is_afloat() && resistance < 0.) {
         ship_state = State_t::sunk;
         set_speed(0.);
@@ -202,6 +258,9 @@ void Ship::receive_hit(int hit_force, shared_ptr<Ship_component>) {
     }
 }
 
+// Plain ships don't respond to an attack
+void Ship::react_to_hit(shared_ptr<Ship_component>) { }
+
 // Throw error for fat interface functions
 void Ship::set_load_destination(shared_ptr<Island>) {
     throw Error("Cannot load at a destination!");
@@ -227,17 +286,26 @@ void Ship::start_skimming(Point, int) {
     throw Error("Cannot skim!");
 }
 
+// Throw error for fat interface functions
+void Ship::join_spill(shared_ptr<Spill>) {
+    throw Error("Cannot skim!");
+}
+
+/*** Formation functions ***/
+
+void Ship::join_formation(shared_ptr<Formation> formation_, Cartesian_vector offset) {
+    assert(is_moving());
+    formation_place.reset(new Formation_place{formation_, offset});
+}
+
 /* Protected Function Definitions */
 
 // Construct a ship object using the parameters passed by the derived class.
-Ship::Ship(const std::string &name_, Point position_, double fuel_capacity_,
-        double maximum_speed_, double fuel_consumption_, int resistance_) :
-        Ship_component(name_),
-        fuel {fuel_capacity_}, fuel_capacity {fuel_capacity_},
-        fuel_consumption {fuel_consumption_},
-        destination_point {0., 0.},
-        maximum_speed {maximum_speed_},
-        resistance {resistance_}, track_base(position_) { }
+Ship::Ship(const std::string &name_, Point position_,
+        const Ship_parameters* parameters_) :
+        Ship_component(name_), parameters {parameters_},
+        track_base(position_), fuel {parameters_->fuel_capacity},
+        resistance {parameters_->resistance}, destination_point {0., 0.} { }
 
 
 /* Private Function Definitions */
@@ -258,6 +326,10 @@ For clarity in specifying the computation, this code assumes the specified priva
 but you may change the variable names or enum class names, or state names if you wish (e.g. movement_state).
 */
 void Ship::calculate_movement() {
+    if (formation_place) {
+        calculate_formation_movement();
+        return;
+    }
     // Compute values for how much we need to move, and how much we can, and how long we can,
     // given the fuel state, then decide what to do.
     double time = 1.0;    // "full step" time
@@ -268,7 +340,7 @@ void Ship::calculate_movement() {
     double full_distance = track_base.get_speed() * time;
     // get fuel required for full step distance
     double full_fuel_required =
-            full_distance * fuel_consumption;    // tons = nm * tons/nm
+            full_distance * parameters->fuel_consumption;    // tons = nm * tons/nm
     // how far and how long can we sail in this time period based on the fuel state?
     double distance_possible, time_possible;
     if (full_fuel_required <= fuel) {
@@ -276,7 +348,7 @@ void Ship::calculate_movement() {
         time_possible = time;
     }
     else {
-        distance_possible = fuel / fuel_consumption;    // nm = tons / tons/nm
+        distance_possible = fuel / parameters->fuel_consumption;    // nm = tons / tons/nm
         time_possible = (distance_possible / full_distance) * time;
     }
 
@@ -287,7 +359,7 @@ void Ship::calculate_movement() {
         // yes, make our new position the destination
         set_position(destination_point);
         // we travel the destination distance, using that much fuel
-        double fuel_required = destination_distance * fuel_consumption;
+        double fuel_required = destination_distance * parameters->fuel_consumption;
         set_fuel(fuel - fuel_required);
         set_speed(0.);
         ship_state = State_t::stopped;
@@ -295,10 +367,14 @@ void Ship::calculate_movement() {
     else {
         // go as far as we can, stay in the same movement state
         // simply move for the amount of time possible
+        Point old_location = track_base.get_position();
         track_base.update_position(time_possible);
         // update_position does not call set_position, so send a notification
         // for the location that we are now at.
         Model::get_inst()->notify_location(get_name(), track_base.get_position());
+        auto group_ptr = get_parent_group();
+        if (group_ptr)
+            group_ptr->member_location_changed(old_location, track_base.get_position());
         // have we used up our fuel?
         if (full_fuel_required >= fuel) {
             set_fuel(0.);
@@ -311,9 +387,38 @@ void Ship::calculate_movement() {
     }
 }
 
+/*
+The formation's reference point moves on the same course and speed as the ship,
+so taking our position from it gives the same result as moving ourselves. A ship
+that doesn't have the fuel for the full step leaves the formation and moves on its
+own for the rest of the tick, which leaves it dead in the water.
+*/
+void Ship::calculate_formation_movement() {
+    auto& formation = formation_place->formation;
+    formation->advance(Model::get_inst()->get_time());
+    double fuel_required = formation->get_step_distance() * parameters->fuel_consumption;
+    bool can_keep_up = formation->has_arrived() ?
+            fuel_required <= fuel : fuel_required < fuel;
+    if (!can_keep_up) {
+        formation_place.reset();
+        calculate_movement();
+        return;
+    }
+
+    set_position(formation->get_position() + formation_place->offset);
+    set_fuel(fuel - fuel_required);
+    if (formation->has_arrived()) {
+        set_speed(0.);
+        ship_state = State_t::stopped;
+        formation_place.reset();
+    }
+}
+
 // Reset the destination state, usually called if we change how the ship is
 // moving in any of the set_destination functions, or by stopping the ship.
+// This also takes us out of any formation.
 void Ship::reset_destinations_and_dock() {
+    formation_place.reset();
     destination_point = {0., 0.};
     docked_Island = nullptr;
     destination_Island = nullptr;
@@ -328,10 +433,14 @@ void Ship::set_speed_with_check(double speed) {
     set_speed(speed);
 }
 
-// Set the position of the ship and tell the model where we are
+// Set the position of the ship and tell the model and our group where we are
 void Ship::set_position(Point point) {
+    Point old_location = track_base.get_position();
     track_base.set_position(point);
     Model::get_inst()->notify_location(get_name(), point);
+    auto group_ptr = get_parent_group();
+    if (group_ptr)
+        group_ptr->member_location_changed(old_location, point);
 }
 
 // Set the course and tell the model what it is
@@ -346,9 +455,13 @@ void Ship::set_speed(double speed) {
     Model::get_inst()->notify_speed(get_name(), speed);
 }
 
-// Set the fuel and tell the model what it is
+// Set the fuel and tell the model and our group what it is
 void Ship::set_fuel(double fuel_) {
+    double old_fuel = fuel;
     fuel = fuel_;
     Model::get_inst()->notify_fuel(get_name(), fuel);
+    auto group_ptr = get_parent_group();
+    if (group_ptr)
+        group_ptr->member_fuel_changed(old_fuel, fuel);
 }
 
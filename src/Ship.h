@@ -21,8 +21,10 @@ functions are implemented in this class to throw an Error exception.
 
 #include "Track_base.h"
 #include "Ship_component.h"
+#include "Ship_parameters.h"
 
 class Island;
+class Formation;
 
 class Ship : public Ship_component {
 
@@ -49,7 +51,11 @@ public:
 
     // Get the maximum speed for the ship
     double get_maximum_speed() const
-    { return maximum_speed; }
+    { return parameters->maximum_speed; }
+
+    // Get the amount of fuel the ship has left
+    double get_fuel() const
+    { return fuel; }
 
     // return pointer to the Island currently docked at, or nullptr if not docked
     std::shared_ptr<Island> get_docked_Island() const
@@ -59,6 +65,17 @@ public:
     std::shared_ptr<Island> get_destination_Island() const
     { return destination_Island; }
 
+    // Return the parameters of the ship's type that were current when it was created
+    const Ship_parameters& get_parameters() const
+    { return *parameters; }
+
+    // The type the ship was created as, which can be a variant of its class
+    const char* get_type_name() const override
+    { return parameters->type_name.c_str(); }
+
+    const char* get_class_name() const override
+    { return parameters->class_name.c_str(); }
+
     /*** Interface to derived classes ***/
     // Update the state of the Ship
     void update() override;
@@ -69,6 +86,14 @@ public:
     // Broadcast the state of the ship to the Model
     void broadcast_current_state() const override;
 
+    // The ship's share of the formation it is in, if any. Derived classes add
+    // their size and the memory they own.
+    std::size_t get_memory_size() const override;
+
+    // Save and restore the parameters, movement, fuel, and damage state of the ship
+    void save_state(Snapshot_writer& writer) const override;
+    void restore_state(Snapshot_reader& reader) override;
+
     /*** Command functions ***/
     // Start moving to a destination position at a speed
     // may throw Error("Ship cannot move!")
@@ -95,14 +120,28 @@ public:
     // may throw Error("Can't dock!");
     void dock(std::shared_ptr<Island> island_ptr) override;
 
-    // Refuel - must already be docked at an island; fill takes as much as possible
+    // Refuel - must already be docked at an island; fill takes as much as possible.
+    // During an update the island may only provide the fuel at the end of it,
+    // see Island::request_fuel().
     // may throw Error("Must be docked!");
     void refuel() override;
 
     // interactions with other objects
-    // receive a hit from an attacker
+    // receive a hit from an attacker: take the hit, sink if out of resistance,
+    // and otherwise react to the attacker
     void receive_hit(int hit_force, std::shared_ptr<Ship_component> attacker_ptr) override;
 
+    // The steps of receive_hit(), for combat that is resolved in phases
+    // Lose resistance from a hit
+    void take_hit(int hit_force);
+
+    // Sink the ship if it is afloat with negative resistance, removing it from
+    // its group and from the Model
+    void check_sinking();
+
+    // Respond to having been hit by attacker_ptr. Does nothing by default.
+    virtual void react_to_hit(std::shared_ptr<Ship_component> attacker_ptr);
+
     /*** Fat interface command functions ***/
     // These functions throw an Error exception for this class
     // will always throw Error("Cannot load at a destination!");
@@ -120,30 +159,50 @@ public:
     // will always throw Error("Cannot skim!");
     void start_skimming(Point spill_origin_, int spill_size_) override;
 
+    // will always throw Error("Cannot skim!");
+    void join_spill(std::shared_ptr<Spill> spill_ptr) override;
+
+    /*** Formation functions ***/
+    // Keep offset from the formation's reference point while moving, instead of
+    // navigating on our own. The ship must already have been given the same course
+    // and speed as the formation, or a destination at offset from the formation's.
+    // Any later command that changes how the ship moves takes it out of the formation.
+    void join_formation(std::shared_ptr<Formation> formation_, Cartesian_vector offset);
+
 protected:
     // Protected to prevent construction of plain ship objects
-    Ship(const std::string &name_, Point position_, double fuel_capacity_,
-            double maximum_speed_, double fuel_consumption_, int resistance_);
+    // Fuel, speed, and resistance values are taken from parameters_, which must
+    // be a block from the ship type registry, see Ship_parameters.h
+    Ship(const std::string &name_, Point position_,
+            const Ship_parameters* parameters_);
 
 private:
+    // The members that every update uses come first, so that they share a cache
+    // line. The constants of the ship's type are in its shared parameter block,
+    // and the formation members, which few ships need, are kept out of line.
+    const Ship_parameters* parameters;  // Shared by the ships of the type
+    Track_base track_base;              // Location tracking and navigation
     double fuel;                        // Current amount of fuel
-    double fuel_capacity;               // Amount of fuel ship can hold
-    double fuel_consumption;            // tons/nm required per cycle
-    Point destination_point;            // Current destination position
-    std::shared_ptr<Island> docked_Island;    // Island we're docked at
-    std::shared_ptr<Island> destination_Island; // Current destination Island, if any
-    enum class State_t {
+    int resistance;                     // Resistance to damage for the ship
+    enum class State_t : unsigned char {
         docked, stopped, moving_on_course, dead_in_the_water,
         moving_to_position, moving_to_island, sunk
     } ship_state = State_t::stopped;      // State of the ship
-    double maximum_speed;               // Maximum speed the ship supports
-    int resistance;                     // Resistance to damage for the ship
-    Track_base track_base;              // Location tracking and navigation
-
+    Point destination_point;            // Current destination position
+    std::shared_ptr<Island> destination_Island; // Current destination Island, if any
+    std::shared_ptr<Island> docked_Island;    // Island we're docked at
+    struct Formation_place {
+        std::shared_ptr<Formation> formation;   // Formation we are moving in
+        Cartesian_vector offset;    // Our offset from the formation's position
+    };
+    std::unique_ptr<Formation_place> formation_place; // Null if not in a formation
 
     // Updates position, fuel, and movement_state, assuming 1 time unit (1 hr)
     void calculate_movement();
 
+    // Does the same as calculate_movement(), using the formation's position
+    void calculate_formation_movement();
+
     // Reset the destination point, destination island, and docked island
     void reset_destinations_and_dock();
 
@@ -8,6 +8,7 @@
 
 class Island;
 class Ship_group;
+class Spill;
 
 /* Ship_component class
  *
@@ -25,6 +26,13 @@ public:
     // Construct a Ship_component, passing the name to the base Sim_object
     Ship_component(const std::string& name);
 
+    // Return the type name that create_ship() uses to create this kind of object
+    virtual const char* get_type_name() const = 0;
+
+    // Return the name of the class whose behavior this object has, which is the
+    // same for every ship of a type for the life of the program
+    virtual const char* get_class_name() const = 0;
+
     /*** Group related functions ***/
     // Throws an Error if called, should be overrode by group class
     virtual void add_child(std::shared_ptr<Ship_component> ship_ptr);
@@ -63,8 +71,14 @@ public:
     virtual void attack(std::shared_ptr<Ship_component> target_ptr) = 0;
     virtual void stop_attack() = 0;
     virtual void start_skimming(Point spill_origin_, int spill_size_) = 0;
+    virtual void join_spill(std::shared_ptr<Spill> spill_ptr) = 0;
     virtual void receive_hit(int hit_force,
             std::shared_ptr<Ship_component> attacker_ptr) = 0;
+protected:
+    // Return the parent group, or null if there is none.
+    std::shared_ptr<Ship_group> get_parent_group() const noexcept
+        { return parent.lock(); }
+
 private:
     // Pointer to the parent group of this object.
     std::weak_ptr<Ship_group> parent;
@@ -6,31 +6,124 @@
 #include "Cruise_ship.h"
 #include "Skimmer.h"
 #include "Ship_group.h"
+#include "Ship_parameters.h"
 #include "Utility.h"
 
+#include <algorithm>
+#include <iterator>
+#include <cassert>
+
 using namespace std;
 
+/* The ship classes
+ * Each built-in class is listed with functions that make a ship of the class and
+ * update a batch of them. The update functions call the class's own update
+ * function with a qualified call, which the compiler can inline, instead of the
+ * virtual one. Ship types, with their parameters, are defined in Ship_parameters;
+ * each type has the behavior of one of these classes. Groups have no parameters
+ * and are not a ship type, so the group class is listed on its own.
+ */
+
+template <typename T>
+static shared_ptr<Ship_component> make_ship(const string& name, Point initial_position,
+        const Ship_parameters* parameters) {
+    return make_shared<T>(name, initial_position, parameters);
+}
+
+static shared_ptr<Ship_component> make_group(const string& name, Point,
+        const Ship_parameters*) {
+    return make_shared<Ship_group>(name);
+}
+
+// Ships removed earlier in the update leave cleared entries, which are skipped
+template <typename T>
+static void update_ships(const Ship_entries_t& ships, const vector<size_t>& indices) {
+    for (size_t index : indices) {
+        Ship_component* ship_ptr = ships[index].second.get();
+        if (ship_ptr)
+            static_cast<T*>(ship_ptr)->T::update();
+    }
+}
+
+struct Ship_class {
+    const char* name;
+    shared_ptr<Ship_component> (*make_fn) (const string& name, Point initial_position,
+            const Ship_parameters* parameters);
+    Ship_update_fn_t update_fn;
+};
+
+const Ship_class ship_classes_c[] = {
+    {"Cruiser", &make_ship<Cruiser>, &update_ships<Cruiser>},
+    {"Tanker", &make_ship<Tanker>, &update_ships<Tanker>},
+    {"Cruise_ship", &make_ship<Cruise_ship>, &update_ships<Cruise_ship>},
+    {"Torpedo_boat", &make_ship<Torpedo_boat>, &update_ships<Torpedo_boat>},
+    {"Skimmer", &make_ship<Skimmer>, &update_ships<Skimmer>}
+};
+
+const Ship_class group_class_c = {"Group", &make_group, &update_ships<Ship_group>};
+
+// Return the class of the objects of type, and set parameters to the type's
+// current parameters, or nullptr for groups. Return nullptr if there is no
+// such type.
+static const Ship_class* find_ship_class(const string& type,
+        const Ship_parameters*& parameters) {
+    parameters = nullptr;
+    if (type == group_class_c.name)
+        return &group_class_c;
+    parameters = find_ship_parameters(type);
+    if (!parameters)
+        return nullptr;
+    auto class_it = find_if(begin(ship_classes_c), end(ship_classes_c),
+            [parameters](const Ship_class& ship_class) {
+                return parameters->class_name == ship_class.name;
+            });
+    assert(class_it != end(ship_classes_c));
+    return class_it;
+}
+
 // Create a new ship of type `type`. Return a pointer to the new ship.
 // If the type is unrecognized, throw an error.
 shared_ptr<Ship_component> create_ship(const string& name,
         const string& type, Point initial_position) {
-    if (type == "Cruiser") {
-        return make_shared<Cruiser>(name, initial_position);
-    } else if (type == "Tanker") {
-        return make_shared<Tanker>(name, initial_position);
-    } else if (type == "Cruise_ship") {
-        return make_shared<Cruise_ship>(name, initial_position);
-    } else if (type == "Torpedo_boat") {
-        return make_shared<Torpedo_boat>(name, initial_position);
-    } else if (type == "Skimmer") {
-        return make_shared<Skimmer>(name, initial_position);
-    } else if (type == "Group") {
-        return make_shared<Ship_group>(name);
-    } else {
+    const Ship_parameters* parameters;
+    const Ship_class* ship_class = find_ship_class(type, parameters);
+    if (!ship_class)
         throw Error("Trying to create ship of unknown type!");
-    }
+    return ship_class->make_fn(name, initial_position, parameters);
 }
 
 shared_ptr<Ship_component> create_group(const string& name) {
     return make_shared<Ship_group>(name);
-}
\ No newline at end of file
+}
+
+// Return the class named class_name, or nullptr if there is none. A ship's type
+// name may have been defined again with another class since the ship was made,
+// so ships that exist are looked up by their class name.
+static const Ship_class* find_class_by_name(const string& class_name) {
+    if (class_name == group_class_c.name)
+        return &group_class_c;
+    auto class_it = find_if(begin(ship_classes_c), end(ship_classes_c),
+            [&class_name](const Ship_class& ship_class) {
+                return class_name == ship_class.name;
+            });
+    return class_it != end(ship_classes_c) ? class_it : nullptr;
+}
+
+// Groups are made without parameters
+shared_ptr<Ship_component> create_ship_of_class(const string& name,
+        const string& class_name) {
+    const Ship_class* ship_class = find_class_by_name(class_name);
+    if (!ship_class)
+        return nullptr;
+    const Ship_parameters* parameters = nullptr;
+    if (ship_class != &group_class_c)
+        parameters = find_class_parameters(class_name);
+    assert(ship_class == &group_class_c || parameters);
+    return ship_class->make_fn(name, Point(), parameters);
+}
+
+// Look up the update function of the class
+Ship_update_fn_t get_ship_update_fn(const string& class_name) {
+    const Ship_class* ship_class = find_class_by_name(class_name);
+    return ship_class ? ship_class->update_fn : nullptr;
+}
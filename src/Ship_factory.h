@@ -2,9 +2,11 @@
 #define SHIP_FACTORY_H
 
 #include "Geometry.h"
+#include "Name_table.h"
 
 #include <string>
 #include <memory>
+#include <vector>
 
 class Ship_component;
 /* This is a very simple form of factory, a function; you supply the information, it creates
@@ -12,11 +14,31 @@ the specified kind of object and returns a pointer to it. The Ship is allocated
 with new, so some other component is responsible for deleting it.
 */
 
-// Construct a new ship of type `type`.
+// Construct a new ship of type `type`, which is either a ship type, see
+// Ship_parameters.h, or "Group".
 // May throw Error("Trying to create ship of unknown type!")
 std::shared_ptr<Ship_component> create_ship(const std::string& name,
         const std::string& type, Point initial_position);
 
 std::shared_ptr<Ship_component> create_group(const std::string& name);
 
+// Construct a new ship of class class_name with the built-in parameters of the
+// class, or a group if class_name is "Group", for a snapshot to restore the rest
+// of its state. Return nullptr if there is no such class.
+std::shared_ptr<Ship_component> create_ship_of_class(const std::string& name,
+        const std::string& class_name);
+
+// The entries of the Model's ships, in name order
+using Ship_entries_t = Name_table<Ship_component>::Entries_t;
+
+// Updates the ships at indices in ships, which must all be of one class, skipping
+// cleared entries. Calls the class's update function directly, not through the
+// virtual function.
+using Ship_update_fn_t = void (*) (const Ship_entries_t& ships,
+        const std::vector<std::size_t>& indices);
+
+// Return the update function for the class of ships whose get_class_name() is
+// class_name, or nullptr if class_name is not a ship class or "Group"
+Ship_update_fn_t get_ship_update_fn(const std::string& class_name);
+
 #endif
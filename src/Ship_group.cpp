@@ -1,23 +1,108 @@
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include "Ship_group.h"
 #include "Utility.h"
+#include "Snapshot.h"
+#include "Model.h"
+#include "Ship.h"
+#include "Formation.h"
+#include "Thread_pool.h"
+#include "Spill.h"
 
 using namespace std;
 using namespace placeholders;
 
+// Groups with fewer members than this are always commanded one ship at a time
+const size_t parallel_min_members_c = 64;
+// The members are split into this many ranges per thread to even out the work
+const int ranges_per_thread_c = 4;
+
+// The threads used to command large groups, null when commands are given one
+// ship at a time
+static unique_ptr<Thread_pool> command_pool;
+
+// Where cout output goes on each thread while a command runs in parallel
+static thread_local string* thread_output = nullptr;
+
+// Used in place of cout's buffer while a command runs in parallel, to send what
+// each thread writes to its own string
+class Thread_output_buffer : public streambuf {
+protected:
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+            thread_output->push_back(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    }
+    streamsize xsputn(const char* s, streamsize count) override {
+        thread_output->append(s, count);
+        return count;
+    }
+};
+
 /* Templated private member functions */
 
-// Loop through all children, apply the provided function, and if an error
+// Loop through all member ships, apply the provided function, and if an error
 // occurs, print out the error message, but continue the loop.
 template <typename T>
-void Ship_group::for_each_child_catch(T func) const {
-    for (auto& map_pair : children) {
+void Ship_group::for_each_member_catch(T func) const {
+    for (auto& ship_ptr : get_cached_member_ships()) {
         try {
-            func(map_pair.second.lock());
+            func(ship_ptr);
         } catch (Error& e) {
-            std::cout << map_pair.first << ": " << e.what() << std::endl;
+            std::cout << ship_ptr->get_name() << ": " << e.what() << std::endl;
+        }
+    }
+}
+
+// Command the members in ranges, with each range's output and notifications
+// buffered, then print the output and send the notifications in member order.
+// Only one thread writes to cout's buffer or the views at any time.
+template <typename T>
+void Ship_group::for_each_member_parallel(T func) const {
+    auto& members = get_cached_member_ships();
+    if (!command_pool || members.size() < parallel_min_members_c) {
+        for_each_member_catch(func);
+        return;
+    }
+
+    struct Range_result {
+        string output;
+        Model::Notification_queue_t notifications;
+    };
+    int range_count = command_pool->get_thread_count() * ranges_per_thread_c;
+    vector<Range_result> results(range_count);
+    auto command_range = [&members, &results, &func, range_count](int range) {
+        thread_output = &results[range].output;
+        Model::set_notification_queue(&results[range].notifications);
+        size_t end = members.size() * (range + 1) / range_count;
+        for (size_t i = members.size() * range / range_count; i < end; ++i) {
+            try {
+                func(members[i]);
+            } catch (Error& e) {
+                cout << members[i]->get_name() << ": " << e.what() << endl;
+            } catch (...) {
+                Model::set_notification_queue(nullptr);
+                throw;
+            }
         }
+        Model::set_notification_queue(nullptr);
+    };
+
+    Thread_output_buffer output_buffer;
+    streambuf* cout_buffer = cout.rdbuf(&output_buffer);
+    try {
+        command_pool->run(range_count, command_range);
+    } catch (...) {
+        cout.rdbuf(cout_buffer);
+        throw;
+    }
+    cout.rdbuf(cout_buffer);
+
+    for (auto& result : results) {
+        cout << result.output;
+        for (auto& notification : result.notifications)
+            notification();
     }
 }
 
@@ -29,17 +114,20 @@ Ship_group::Ship_group(const string& name_) :
 
 // Add a child to the children map, and set its parent pointer
 void Ship_group::add_child(shared_ptr<Ship_component> ship_ptr) {
-    // If child-to-be is a group, make sure that we are not a member of that group,
-    // else we create a cycle.
+    // If child-to-be is a group, make sure that it is not this group or a group
+    // that we are nested in, else we create a cycle.
     auto composite_ptr = dynamic_pointer_cast<Ship_group>(ship_ptr);
     if (composite_ptr) {
-        if (composite_ptr->is_child_member(get_name()))
+        if (composite_ptr.get() == this || ancestors.count(composite_ptr.get()))
             throw Error("Cycle detected!");
     }
     auto this_group_ptr = static_pointer_cast<Ship_group>(shared_from_this());
     // Will throw an error if the child already has a parent
     ship_ptr->add_parent(this_group_ptr);
     children.insert({ship_ptr->get_name(), ship_ptr});
+    if (composite_ptr)
+        composite_ptr->add_ancestors(get_self_and_ancestors());
+    invalidate_member_ships();
 }
 
 // Remove a child from the children map, and clear its parent pointer
@@ -47,17 +135,28 @@ void Ship_group::remove_child(shared_ptr<Ship_component> child_ptr) {
     auto itt = children.find(child_ptr->get_name());
     if (itt == children.end())
         throw Error("No child with that name!");
-    itt->second.lock()->remove_parent();
+    auto removed_ptr = itt->second.lock();
+    removed_ptr->remove_parent();
     children.erase(itt);
+    auto composite_ptr = dynamic_pointer_cast<Ship_group>(removed_ptr);
+    if (composite_ptr)
+        composite_ptr->remove_ancestors(get_self_and_ancestors());
+    invalidate_member_ships();
 }
 
 // Clear the children map after removing references to this group from the children's
 // parents
 void Ship_group::remove_all_children() {
+    auto self_and_ancestors = get_self_and_ancestors();
     for (auto& map_pair : children) {
-        map_pair.second.lock()->remove_parent();
+        auto child_ptr = map_pair.second.lock();
+        child_ptr->remove_parent();
+        auto composite_ptr = dynamic_pointer_cast<Ship_group>(child_ptr);
+        if (composite_ptr)
+            composite_ptr->remove_ancestors(self_and_ancestors);
     }
     children.clear();
+    invalidate_member_ships();
 }
 
 // Get a child pointer using the child's name.
@@ -69,6 +168,69 @@ shared_ptr<Ship_component> Ship_group::get_child(const string& name) {
         return child_itt->second.lock();
 }
 
+// Return a copy of the cached list
+vector<shared_ptr<Ship_component>> Ship_group::get_member_ships() const {
+    return get_cached_member_ships();
+}
+
+// Bring the totals up to date if needed, then take the averages
+Group_summary Ship_group::get_summary() const {
+    if (!totals_valid || !extremes_valid)
+        compute_totals();
+    Group_summary summary;
+    summary.ship_count = static_cast<int>(get_cached_member_ships().size());
+    if (summary.ship_count > 0) {
+        summary.centroid = Point(x_total / summary.ship_count, y_total / summary.ship_count);
+        summary.bounds_low = bounds_low;
+        summary.bounds_high = bounds_high;
+        summary.total_fuel = fuel_total;
+        summary.min_fuel = min_fuel;
+    }
+    return summary;
+}
+
+// A member's change is saved for later if the member is being commanded on
+// another thread, since several members may report at once.
+void Ship_group::member_location_changed(Point old_location, Point new_location) {
+    if (Model::is_queueing_notifications()) {
+        Model::queue_notification(bind(&Ship_group::member_location_changed,
+                static_pointer_cast<Ship_group>(shared_from_this()),
+                old_location, new_location));
+        return;
+    }
+    update_location_totals(old_location, new_location);
+    for (Ship_group* ancestor_ptr : ancestors)
+        ancestor_ptr->update_location_totals(old_location, new_location);
+}
+
+// Same as for a change of location
+void Ship_group::member_fuel_changed(double old_fuel, double new_fuel) {
+    if (Model::is_queueing_notifications()) {
+        Model::queue_notification(bind(&Ship_group::member_fuel_changed,
+                static_pointer_cast<Ship_group>(shared_from_this()),
+                old_fuel, new_fuel));
+        return;
+    }
+    update_fuel_totals(old_fuel, new_fuel);
+    for (Ship_group* ancestor_ptr : ancestors)
+        ancestor_ptr->update_fuel_totals(old_fuel, new_fuel);
+}
+
+// The leader must be one of the individual ships
+void Ship_group::set_formation_leader(shared_ptr<Ship_component> leader_ptr) {
+    auto& members = get_cached_member_ships();
+    if (leader_ptr && find(members.begin(), members.end(), leader_ptr) == members.end())
+        throw Error("Leader is not in the group!");
+    formation_leader = leader_ptr;
+}
+
+// Replace the pool of command threads
+void Ship_group::set_command_threads(int thread_count) {
+    command_pool.reset();
+    if (thread_count > 1)
+        command_pool.reset(new Thread_pool(thread_count));
+}
+
 // Group doesn't have a location
 Point Ship_group::get_location() const {
     throw Error("Is not an individual!");
@@ -79,6 +241,13 @@ Point Ship_group::get_location() const {
 // Don't need to do anything during an update for a group
 void Ship_group::update() { }
 
+// The members are shared with the Model, so only the containers are counted
+size_t Ship_group::get_memory_size() const {
+    return sizeof(Ship_group) + get_tree_memory_size(children) +
+            member_ships.capacity() * sizeof(member_ships[0]) +
+            get_hash_table_memory_size(ancestors);
+}
+
 // Describe the ship using its name and a list of its immediate members
 void Ship_group::describe() const {
     cout << "\nGroup " << get_name() << endl;
@@ -97,44 +266,85 @@ void Ship_group::describe() const {
         }
         cout << endl;
     }
+    Group_summary summary = get_summary();
+    if (summary.ship_count > 0) {
+        cout << "Ships: " << summary.ship_count << ", centroid: " << summary.centroid <<
+                ", extent: " << summary.bounds_low << " to " << summary.bounds_high << endl;
+        cout << "Fuel: " << summary.total_fuel << " tons total, " <<
+                summary.min_fuel << " tons lowest" << endl;
+    }
+    auto leader_ptr = formation_leader.lock();
+    if (leader_ptr)
+        cout << "Sailing in formation with " << leader_ptr->get_name() << endl;
 }
 
-// Don't need to broadcast the state of the group
-void Ship_group::broadcast_current_state() const { }
+// Send the summary to the views
+void Ship_group::broadcast_current_state() const {
+    broadcast_scheduled = false;
+    Model::get_inst()->notify_group(get_name(), get_summary());
+}
+
+// Save the names of the children and of the formation leader
+void Ship_group::save_state(Snapshot_writer& writer) const {
+    writer.write_int(static_cast<int>(children.size()));
+    for (auto& map_pair : children)
+        writer.write_ship(map_pair.second.lock());
+    writer.write_ship(formation_leader.lock());
+}
+
+// Add the saved children back to the group
+void Ship_group::restore_state(Snapshot_reader& reader) {
+    for (int i = reader.read_int(); i > 0; --i) {
+        auto child_ptr = reader.read_ship();
+        if (!child_ptr)
+            throw Error("Invalid snapshot file!");
+        add_child(child_ptr);
+    }
+    formation_leader = reader.read_ship();
+}
 
 /* Command functions */
-// All command functions call the corresponding command function on all children
-// using the for_each_child_catch() helper function.
+// All command functions call the corresponding command function on all member
+// ships using the for_each_member_parallel() helper function, except refuel(),
+// since ships docked at the same island take fuel from it in turn.
 
 void Ship_group::set_destination_position_and_speed(
         Point destination_position, double speed) {
-    for_each_child_catch(
+    if (!formation_leader.expired()) {
+        move_in_formation(0., speed, &destination_position);
+        return;
+    }
+    for_each_member_parallel(
             bind(&Ship_component::set_destination_position_and_speed, _1,
                     destination_position, speed));
 }
 
 void Ship_group::set_destination_island_and_speed(
         shared_ptr<Island> destination_island, double speed) {
-    for_each_child_catch(
+    for_each_member_parallel(
             bind(&Ship_component::set_destination_island_and_speed, _1,
                     destination_island, speed));
 }
 
 void Ship_group::set_course_and_speed(double course, double speed) {
-    for_each_child_catch(
+    if (!formation_leader.expired()) {
+        move_in_formation(course, speed, nullptr);
+        return;
+    }
+    for_each_member_parallel(
             bind(&Ship_component::set_course_and_speed, _1, course, speed));
 }
 
 void Ship_group::stop() {
-    for_each_child_catch(mem_fn(&Ship_component::stop));
+    for_each_member_parallel(mem_fn(&Ship_component::stop));
 }
 
 void Ship_group::dock(shared_ptr<Island> island_ptr) {
-    for_each_child_catch(bind(&Ship_component::dock, _1, island_ptr));
+    for_each_member_parallel(bind(&Ship_component::dock, _1, island_ptr));
 }
 
 void Ship_group::refuel() {
-    for_each_child_catch(mem_fn(&Ship_component::refuel));
+    for_each_member_catch(mem_fn(&Ship_component::refuel));
 }
 
 // Is not implemented since a group of unrelated ships should not be able to
@@ -144,42 +354,190 @@ void Ship_group::receive_hit(int, shared_ptr<Ship_component>) {
 }
 
 void Ship_group::set_load_destination(shared_ptr<Island> island_ptr) {
-    for_each_child_catch(
+    for_each_member_parallel(
             bind(&Ship_component::set_load_destination, _1, island_ptr));
 }
 
 void Ship_group::set_unload_destination(shared_ptr<Island> island_ptr) {
-    for_each_child_catch(
+    for_each_member_parallel(
             bind(&Ship_component::set_unload_destination, _1, island_ptr));
 }
 
 void Ship_group::attack(shared_ptr<Ship_component> target_ptr) {
-    for_each_child_catch(bind(&Ship_component::attack, _1, target_ptr));
+    for_each_member_parallel(bind(&Ship_component::attack, _1, target_ptr));
 }
 
 void Ship_group::stop_attack() {
-    for_each_child_catch(mem_fn(&Ship_component::stop_attack));
+    for_each_member_parallel(mem_fn(&Ship_component::stop_attack));
 }
 
+// The members join one at a time, and the strips are only assigned once they have
+// all joined
 void Ship_group::start_skimming(Point spill_origin_, int spill_size_) {
-    for_each_child_catch(bind(&Ship_component::start_skimming, _1,
-            spill_origin_, spill_size_));
+    auto spill_ptr = make_shared<Spill>(spill_origin_, spill_size_);
+    join_spill(spill_ptr);
+    spill_ptr->assign_strips();
+}
+
+void Ship_group::join_spill(shared_ptr<Spill> spill_ptr) {
+    for_each_member_catch(bind(&Ship_component::join_spill, _1, spill_ptr));
 }
 
 /* Private member functions */
 
-// If a child is a member of either this group or a subgroup, return true, else return false
-bool Ship_group::is_child_member(const string& name) const {
-    for (const auto& map_pair : children) {
-        auto component_ptr = map_pair.second.lock();
-        // If the name matches, return true
-        if (component_ptr->get_name() == name)
-            return true;
+// Every ship is given the same order it would get on its own, with the speed
+// limited and the destination moved by its offset, then joins the formation.
+void Ship_group::move_in_formation(double course, double speed, const Point* destination) {
+    auto& members = get_cached_member_ships();
+    auto leader_ptr = formation_leader.lock();
+    if (find(members.begin(), members.end(), leader_ptr) == members.end())
+        throw Error("Leader is not in the group!");
+
+    // The members of a group are always individual ships
+    for (auto& member_ptr : members)
+        speed = min(speed, static_pointer_cast<Ship>(member_ptr)->get_maximum_speed());
+
+    Point leader_position = leader_ptr->get_location();
+    auto formation = destination ?
+            make_shared<Formation>(leader_position, speed, *destination) :
+            make_shared<Formation>(leader_position, course, speed);
+    for (auto& member_ptr : members) {
+        Cartesian_vector offset(leader_position, member_ptr->get_location());
+        try {
+            if (destination)
+                member_ptr->set_destination_position_and_speed(*destination + offset, speed);
+            else
+                member_ptr->set_course_and_speed(course, speed);
+            static_pointer_cast<Ship>(member_ptr)->join_formation(formation, offset);
+        } catch (Error& e) {
+            cout << member_ptr->get_name() << ": " << e.what() << endl;
+        }
+    }
+}
+
+// Build the list from the children, using each subgroup's own cached list
+const vector<shared_ptr<Ship_component>>& Ship_group::get_cached_member_ships() const {
+    if (member_ships_valid)
+        return member_ships;
+    member_ships.clear();
+    for (auto& map_pair : children) {
+        auto child_ptr = map_pair.second.lock();
+        auto group_ptr = dynamic_pointer_cast<Ship_group>(child_ptr);
+        if (group_ptr) {
+            auto& group_ships = group_ptr->get_cached_member_ships();
+            member_ships.insert(member_ships.end(), group_ships.begin(), group_ships.end());
+        } else {
+            member_ships.push_back(child_ptr);
+        }
+    }
+    member_ships_valid = true;
+    return member_ships;
+}
 
-        auto group_ptr = dynamic_pointer_cast<Ship_group>(component_ptr);
-        // Recurse into child groups
-        if (group_ptr && group_ptr->is_child_member(name))
-            return true;
+// Our ships are part of the lists of every group we are nested in
+void Ship_group::invalidate_member_ships() {
+    member_ships_valid = false;
+    member_ships.clear();
+    totals_valid = false;
+    schedule_broadcast();
+    for (Ship_group* ancestor_ptr : ancestors) {
+        ancestor_ptr->member_ships_valid = false;
+        ancestor_ptr->member_ships.clear();
+        ancestor_ptr->totals_valid = false;
+        ancestor_ptr->schedule_broadcast();
     }
-    return false;
+}
+
+// Computing the totals again also clears any rounding errors built up in them
+void Ship_group::compute_totals() const {
+    x_total = y_total = fuel_total = 0.;
+    bool first = true;
+    // The members of a group are always individual ships
+    for (auto& member_ptr : get_cached_member_ships()) {
+        const Ship& ship = static_cast<const Ship&>(*member_ptr);
+        Point location = ship.get_location();
+        x_total += location.x;
+        y_total += location.y;
+        fuel_total += ship.get_fuel();
+        if (first) {
+            bounds_low = bounds_high = location;
+            min_fuel = ship.get_fuel();
+            first = false;
+        } else {
+            bounds_low = Point(min(bounds_low.x, location.x), min(bounds_low.y, location.y));
+            bounds_high = Point(max(bounds_high.x, location.x), max(bounds_high.y, location.y));
+            min_fuel = min(min_fuel, ship.get_fuel());
+        }
+    }
+    totals_valid = true;
+    extremes_valid = true;
+}
+
+// The box can grow to take in the new location, but if the old location was on
+// its edge we can't tell whether it shrinks.
+void Ship_group::update_location_totals(Point old_location, Point new_location) {
+    schedule_broadcast();
+    if (!totals_valid)
+        return;
+    x_total += new_location.x - old_location.x;
+    y_total += new_location.y - old_location.y;
+    if (!extremes_valid)
+        return;
+    if (old_location.x == bounds_low.x || old_location.x == bounds_high.x ||
+            old_location.y == bounds_low.y || old_location.y == bounds_high.y) {
+        extremes_valid = false;
+        return;
+    }
+    bounds_low = Point(min(bounds_low.x, new_location.x), min(bounds_low.y, new_location.y));
+    bounds_high = Point(max(bounds_high.x, new_location.x), max(bounds_high.y, new_location.y));
+}
+
+// Likewise the lowest fuel is only lost if it was the lowest ship's fuel that rose
+void Ship_group::update_fuel_totals(double old_fuel, double new_fuel) {
+    schedule_broadcast();
+    if (!totals_valid)
+        return;
+    fuel_total += new_fuel - old_fuel;
+    if (!extremes_valid)
+        return;
+    if (new_fuel <= min_fuel)
+        min_fuel = new_fuel;
+    else if (old_fuel == min_fuel)
+        extremes_valid = false;
+}
+
+// Only schedule once until the summary is sent
+void Ship_group::schedule_broadcast() {
+    if (broadcast_scheduled)
+        return;
+    broadcast_scheduled = true;
+    Model::get_inst()->schedule_broadcast(shared_from_this());
+}
+
+// Add the ancestors to this group, then to the groups nested in it
+void Ship_group::add_ancestors(const unordered_set<Ship_group*>& new_ancestors) {
+    ancestors.insert(new_ancestors.begin(), new_ancestors.end());
+    for (auto& map_pair : children) {
+        auto group_ptr = dynamic_pointer_cast<Ship_group>(map_pair.second.lock());
+        if (group_ptr)
+            group_ptr->add_ancestors(new_ancestors);
+    }
+}
+
+// Remove the ancestors from this group, then from the groups nested in it
+void Ship_group::remove_ancestors(const unordered_set<Ship_group*>& old_ancestors) {
+    for (Ship_group* ancestor_ptr : old_ancestors)
+        ancestors.erase(ancestor_ptr);
+    for (auto& map_pair : children) {
+        auto group_ptr = dynamic_pointer_cast<Ship_group>(map_pair.second.lock());
+        if (group_ptr)
+            group_ptr->remove_ancestors(old_ancestors);
+    }
+}
+
+// The groups that a new subgroup becomes nested in
+unordered_set<Ship_group*> Ship_group::get_self_and_ancestors() {
+    unordered_set<Ship_group*> self_and_ancestors(ancestors);
+    self_and_ancestors.insert(this);
+    return self_and_ancestors;
 }
@@ -2,9 +2,12 @@
 #define SHIP_COMPOSITE_H
 
 #include "Ship_component.h"
+#include "Group_summary.h"
 #include "Utility.h"
 
 #include <map>
+#include <vector>
+#include <unordered_set>
 #include <iostream>
 
 /* Ship_group class
@@ -24,6 +27,31 @@
  * group and reset it when the child is removed from the group. Children should
  * ask their parents to remove them from their groups if necessary, and the parent
  * will clear the child's parent pointer.
+ *
+ * Commands go straight to the individual ships of the group and all of its
+ * subgroups, using a flattened list of the ships that is cached in each group.
+ * The list is rebuilt the next time it is needed after the membership of the
+ * group, or of any group nested in it, changes. Each group also knows all of the
+ * groups it is nested in, so adding a group can be checked for cycles at once.
+ *
+ * Commands to large groups can be spread over several threads, see
+ * set_command_threads(). Each thread buffers the output and view notifications
+ * of the ships it commands, and these are sent on in member order once all of
+ * the threads are done, so the result is the same as giving the commands one
+ * ship at a time.
+ *
+ * A group with a formation leader sails in formation: course and position commands
+ * move the whole group as a unit, at the requested speed or the top speed of its
+ * slowest ship if that is lower, with every ship keeping its current offset from
+ * the leader. See Formation.h.
+ *
+ * Each group keeps a summary of its ships: how many there are, their centroid and
+ * bounding box, and their total and lowest fuel. Ships report every change of
+ * position or fuel to their group, which updates its running totals and those of
+ * the groups it is nested in at constant cost. The bounding box and lowest fuel
+ * are worked out again from the ships only when they are next needed after a ship
+ * on their edge moves inwards, or after the membership changes. Changed summaries
+ * are sent to the views at the end of each update.
  */
 
 class Ship_group : public Ship_component {
@@ -34,7 +62,8 @@ public:
     /*** Component functions ***/
     // Add a child to the group, the child may throw an error if it is already
     // a member of a group. This function throws an error if adding the component
-    // to the group would cause a cycle of groups to occur.
+    // to the group would cause a cycle of groups to occur, including adding a
+    // group to itself.
     void add_child(std::shared_ptr<Ship_component> ship_ptr) override;
 
     // Remove a child from the group. Throws an error if the child is not in the group.
@@ -46,6 +75,28 @@ public:
     // Get a child from the group of children by name.
     std::shared_ptr<Ship_component> get_child(const std::string& name) override;
 
+    // Return every individual ship in this group and its subgroups
+    std::vector<std::shared_ptr<Ship_component>> get_member_ships() const;
+
+    // Return the summary of the ships in the group and its subgroups
+    Group_summary get_summary() const;
+
+    // Called by a member ship, directly or in a subgroup, when its location or
+    // fuel changes, to update the summaries of this group and the groups it is
+    // nested in.
+    void member_location_changed(Point old_location, Point new_location);
+    void member_fuel_changed(double old_fuel, double new_fuel);
+
+    // Make the group sail in formation with leader_ptr, which must be one of its
+    // individual ships. nullptr returns the group to normal commands, but ships
+    // already moving in formation stay in it until they are given a new command.
+    // may throw Error("Leader is not in the group!")
+    void set_formation_leader(std::shared_ptr<Ship_component> leader_ptr);
+
+    // Use thread_count threads to give commands to the ships of large groups.
+    // 1 gives the commands one ship at a time, which is the default.
+    static void set_command_threads(int thread_count);
+
     // Group doesn't have a location, throw an error
     Point get_location() const override;
 
@@ -53,12 +104,26 @@ public:
     // Update the state of the group (currently does nothing)
     void update() override;
 
-    // Describe the group by printing its name and the names of its direct children
+    // Describe the group by printing its name, the names of its direct children,
+    // and the summary of its ships
     void describe() const override;
 
-    // Broadcast the state of the group (currently does nothing)
+    // Include the children, member list, and ancestors
+    std::size_t get_memory_size() const override;
+
+    // Broadcast the summary of the group's ships
     void broadcast_current_state() const override;
 
+    const char* get_type_name() const override
+        { return "Group"; }
+    const char* get_class_name() const override
+        { return "Group"; }
+
+    // Save and restore the names of the children, restoring adds each child back
+    // to the group
+    void save_state(Snapshot_writer& writer) const override;
+    void restore_state(Snapshot_reader& reader) override;
+
     /*** Command functions ***/
     // Each of these functions calls the corresponding function on all children.
     // We handle Errors in these functions so all ships in the group will get
@@ -78,24 +143,85 @@ public:
     void set_unload_destination(std::shared_ptr<Island> island_ptr) override;
     void attack(std::shared_ptr<Ship_component> target_ptr) override;
     void stop_attack() override;
+    // The skimmers share the spill, each skimming a strip of it, see Spill.h
     void start_skimming(Point spill_origin_, int spill_size_) override;
+    void join_spill(std::shared_ptr<Spill> spill_ptr) override;
 
 private:
     // Map of the children of the group with the key as the name of the child
     using ChildrenMap_t = std::map<std::string, std::weak_ptr<Ship_component>>;
     ChildrenMap_t children;
 
-    // Run member function func on every child in the children map.
+    // Every individual ship in this group and its subgroups, in the order that
+    // commands reach them: children in name order, with each subgroup's ships in
+    // place of the subgroup. Ships leave their group before they leave the Model,
+    // so the list never holds a ship that is gone.
+    mutable std::vector<std::shared_ptr<Ship_component>> member_ships;
+    mutable bool member_ships_valid = false;
+
+    // The groups this group is nested in, at any depth
+    std::unordered_set<Ship_group*> ancestors;
+
+    // Running totals of the member ships' state, see get_summary(). Nothing is
+    // valid until the totals are first computed from the members, and they are
+    // computed again after the membership changes.
+    mutable bool totals_valid = false;
+    mutable bool extremes_valid = false; // the bounding box and the lowest fuel
+    mutable double x_total = 0.;
+    mutable double y_total = 0.;
+    mutable double fuel_total = 0.;
+    mutable Point bounds_low;
+    mutable Point bounds_high;
+    mutable double min_fuel = 0.;
+    // True if the group is waiting to send its changed summary to the views
+    mutable bool broadcast_scheduled = false;
+
+    // The ship the group sails in formation with, expired if none
+    std::weak_ptr<Ship_component> formation_leader;
+
+    // Run member function func on every individual ship in the group and its
+    // subgroups.
     //
     // func should be a bound member function pointer using mem_fn(func_ptr), or
     // a bind() equivalent that also binds arguments to the function object.
     // func must be able to be called using func(shared_ptr<> child)
     template <typename T>
-    void for_each_child_catch(T func) const;
+    void for_each_member_catch(T func) const;
+
+    // Same as for_each_member_catch(), but the members of a large group are split
+    // between the command threads. func must only change the ship it is given.
+    template <typename T>
+    void for_each_member_parallel(T func) const;
+
+    // Start all of the members moving in a new formation on course, or towards
+    // destination if it is not null. Ships that can't take the order report their
+    // error and are left out.
+    // may throw Error("Leader is not in the group!")
+    void move_in_formation(double course, double speed, const Point* destination);
+
+    // Return member_ships, building it first if the membership has changed
+    const std::vector<std::shared_ptr<Ship_component>>& get_cached_member_ships() const;
+
+    // Throw away the member_ships and totals of this group and every group it is
+    // nested in
+    void invalidate_member_ships();
+
+    // Compute the totals, and the extremes if needed, from the members
+    void compute_totals() const;
+
+    // Update the totals for a change in one member
+    void update_location_totals(Point old_location, Point new_location);
+    void update_fuel_totals(double old_fuel, double new_fuel);
+
+    // Have the summary sent to the views at the next scheduled broadcast
+    void schedule_broadcast();
+
+    // Add or remove groups that this group and all of its subgroups are nested in
+    void add_ancestors(const std::unordered_set<Ship_group*>& new_ancestors);
+    void remove_ancestors(const std::unordered_set<Ship_group*>& old_ancestors);
 
-    // See if a child group with the provided name is a member of either this group or
-    // any subgroups. This us used to ensure we don't have group cycles.
-    bool is_child_member(const std::string& name) const;
+    // Return this group and the groups it is nested in
+    std::unordered_set<Ship_group*> get_self_and_ancestors();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "Ship_parameters.h"
+
+#include "Utility.h"
+#include "Snapshot.h"
+
+#include <unordered_map>
+#include <deque>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+
+using namespace std;
+
+/* The registry of ship types. Every block of parameters ever made is kept in a
+ * deque, which never moves its elements, so pointers to the blocks stay good for
+ * the life of the program. The current block of each type is found by hashing
+ * the type name.
+ */
+
+struct Ship_type_registry {
+    deque<Ship_parameters> blocks;
+    unordered_map<string, const Ship_parameters*> current;
+};
+
+static bool have_same_values(const Ship_parameters& p1, const Ship_parameters& p2);
+static void set_field(Ship_parameters& parameters, const string& field, double value);
+
+// Return the registry, with the built-in types defined on first use. Values are
+// the ones given in the project specification.
+static Ship_type_registry& get_registry() {
+    static Ship_type_registry registry;
+    if (registry.current.empty()) {
+        const Ship_parameters built_in_types[] = {
+            // type, class               fuel cap, max speed, consumption, resistance, firepower, range
+            {"Cruiser", "Cruiser",           1000.,   20.,       10.,         6,          3,         15.},
+            {"Torpedo_boat", "Torpedo_boat", 800.,    12.,       5.,          9,          3,         5.},
+            {"Tanker", "Tanker",             100.,    10.,       2.,          0,          0,         0.},
+            {"Cruise_ship", "Cruise_ship",   500.,    15.,       2.,          0,          0,         0.},
+            {"Skimmer", "Skimmer",           100.,    3.,        0.5,         0,          0,         0.}
+        };
+        for (auto& parameters : built_in_types) {
+            registry.blocks.push_back(parameters);
+            registry.current[parameters.type_name] = &registry.blocks.back();
+        }
+    }
+    return registry;
+}
+
+// Get the parameters of a ship type
+const Ship_parameters& get_ship_parameters(const string& type) {
+    const Ship_parameters* parameters = find_ship_parameters(type);
+    if (!parameters)
+        throw Error("Trying to create ship of unknown type!");
+    return *parameters;
+}
+
+// Look up the type's current block
+const Ship_parameters* find_ship_parameters(const string& type) {
+    auto& current = get_registry().current;
+    auto itt = current.find(type);
+    return itt == current.end() ? nullptr : itt->second;
+}
+
+// The built-in types were the first blocks made, and later blocks of a type with
+// the same name as a class are always after them
+const Ship_parameters* find_class_parameters(const string& class_name) {
+    auto& blocks = get_registry().blocks;
+    auto block_it = find_if(blocks.begin(), blocks.end(),
+            [&class_name](const Ship_parameters& parameters) {
+                return parameters.type_name == class_name && parameters.class_name == class_name;
+            });
+    return block_it == blocks.end() ? nullptr : &*block_it;
+}
+
+// Ships restored from a snapshot almost always have the current parameters of
+// their type, so only those are checked before making a new block
+const Ship_parameters* intern_ship_parameters(const Ship_parameters& parameters) {
+    const Ship_parameters* current = find_ship_parameters(parameters.type_name);
+    if (current && have_same_values(*current, parameters))
+        return current;
+    auto& blocks = get_registry().blocks;
+    blocks.push_back(parameters);
+    return &blocks.back();
+}
+
+// A new block is made even if the values are the same, it costs little
+void define_ship_type(const Ship_parameters& parameters) {
+    auto& registry = get_registry();
+    registry.blocks.push_back(parameters);
+    registry.current[parameters.type_name] = &registry.blocks.back();
+}
+
+// Collect the current blocks and sort them by name
+vector<const Ship_parameters*> get_ship_types() {
+    vector<const Ship_parameters*> types;
+    for (auto& type_pair : get_registry().current)
+        types.push_back(type_pair.second);
+    sort(types.begin(), types.end(), [](const Ship_parameters* p1, const Ship_parameters* p2) {
+        return p1->type_name < p2->type_name;
+    });
+    return types;
+}
+
+// Override a single parameter of a ship type with a new block
+void set_ship_parameter(const string& type, const string& parameter, double value) {
+    Ship_parameters parameters = get_ship_parameters(type);
+    set_field(parameters, parameter, value);
+    define_ship_type(parameters);
+}
+
+// Read all of the types before defining any, so a bad file changes nothing. A
+// type may be like one defined earlier in the same file.
+void load_ship_types(const string& file_name) {
+    ifstream file(file_name);
+    if (!file)
+        throw Error("Could not open ship types file!");
+    vector<Ship_parameters> new_types;
+    string line;
+    while (getline(file, line)) {
+        istringstream line_stream(line);
+        string type_name, like_type;
+        if (!(line_stream >> type_name) || type_name[0] == '#')
+            continue;
+        if (!(line_stream >> like_type))
+            throw Error("Invalid ship types file!");
+        auto like_it = find_if(new_types.rbegin(), new_types.rend(),
+                [&like_type](const Ship_parameters& parameters) {
+                    return parameters.type_name == like_type;
+                });
+        const Ship_parameters* like_parameters = like_it != new_types.rend() ?
+                &*like_it : find_ship_parameters(like_type);
+        if (!like_parameters)
+            throw Error("Invalid ship types file!");
+        Ship_parameters parameters = *like_parameters;
+        parameters.type_name = type_name;
+        string field;
+        double value;
+        while (line_stream >> field) {
+            if (!(line_stream >> value))
+                throw Error("Invalid ship types file!");
+            try {
+                set_field(parameters, field, value);
+            } catch (Error&) {
+                throw Error("Invalid ship types file!");
+            }
+        }
+        if (!has_valid_values(parameters))
+            throw Error("Invalid ship types file!");
+        new_types.push_back(parameters);
+    }
+    for (auto& parameters : new_types)
+        define_ship_type(parameters);
+}
+
+size_t get_ship_parameter_block_count() {
+    return get_registry().blocks.size();
+}
+
+// The blocks, the long names in them, and the hash table of current blocks
+size_t get_ship_parameters_memory_size() {
+    auto& registry = get_registry();
+    size_t size = registry.blocks.size() * sizeof(Ship_parameters) +
+            get_hash_table_memory_size(registry.current);
+    for (auto& parameters : registry.blocks)
+        size += get_string_memory_size(parameters.type_name) +
+                get_string_memory_size(parameters.class_name);
+    return size;
+}
+
+// Write the names and then the numbers
+void save_ship_parameters(Snapshot_writer& writer, const Ship_parameters& parameters) {
+    writer.write_string(parameters.type_name);
+    writer.write_string(parameters.class_name);
+    writer.write_double(parameters.fuel_capacity);
+    writer.write_double(parameters.maximum_speed);
+    writer.write_double(parameters.fuel_consumption);
+    writer.write_int(parameters.resistance);
+    writer.write_int(parameters.firepower);
+    writer.write_double(parameters.attack_range);
+}
+
+// Read them back in the same order
+Ship_parameters restore_ship_parameters(Snapshot_reader& reader) {
+    Ship_parameters parameters;
+    parameters.type_name = reader.read_string();
+    parameters.class_name = reader.read_string();
+    parameters.fuel_capacity = reader.read_double();
+    parameters.maximum_speed = reader.read_double();
+    parameters.fuel_consumption = reader.read_double();
+    parameters.resistance = reader.read_int();
+    parameters.firepower = reader.read_int();
+    parameters.attack_range = reader.read_double();
+    return parameters;
+}
+
+// Compare every field
+static bool have_same_values(const Ship_parameters& p1, const Ship_parameters& p2) {
+    return p1.type_name == p2.type_name && p1.class_name == p2.class_name &&
+            p1.fuel_capacity == p2.fuel_capacity && p1.maximum_speed == p2.maximum_speed &&
+            p1.fuel_consumption == p2.fuel_consumption && p1.resistance == p2.resistance &&
+            p1.firepower == p2.firepower && p1.attack_range == p2.attack_range;
+}
+
+// Set one of the numeric fields by name
+static void set_field(Ship_parameters& parameters, const string& field, double value) {
+    if (field == "fuel_capacity")
+        parameters.fuel_capacity = value;
+    else if (field == "maximum_speed")
+        parameters.maximum_speed = value;
+    else if (field == "fuel_consumption")
+        parameters.fuel_consumption = value;
+    else if (field == "resistance")
+        parameters.resistance = static_cast<int>(lround(value));
+    else if (field == "firepower")
+        parameters.firepower = static_cast<int>(lround(value));
+    else if (field == "attack_range")
+        parameters.attack_range = value;
+    else
+        throw Error("Unknown ship parameter!");
+}
+
+// A ship must be able to hold fuel and move, and nothing can be negative
+bool has_valid_values(const Ship_parameters& parameters) {
+    return parameters.fuel_capacity > 0. && parameters.maximum_speed > 0. &&
+            parameters.fuel_consumption >= 0. && parameters.resistance >= 0 &&
+            parameters.firepower >= 0 && parameters.attack_range >= 0.;
+}
@@ -0,0 +1,99 @@
+#ifndef SHIP_PARAMETERS_H
+#define SHIP_PARAMETERS_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+class Snapshot_writer;
+class Snapshot_reader;
+
+/* Ship_parameters
+ * The constants that govern how each type of Ship moves and fights. Each type of
+ * ship that can be created has a block of parameters, and the ships of the type
+ * keep a pointer to the block that was current when they were created. Blocks
+ * never change and are never freed: changing a parameter of a type makes a new
+ * block for the ships created afterwards, and the ships already created keep
+ * their old one.
+ *
+ * The built-in types start out with the values given in the project specification,
+ * and their class_name is the same as their type_name. Further types, such as a
+ * heavy cruiser, are variants of a built-in class with their own parameters, and
+ * can be defined from a file with load_ship_types() without recompiling. Tools
+ * such as the ensemble runner override individual entries with set_ship_parameter()
+ * before any ships are created in order to explore variations of a scenario.
+ *
+ * Ship types files have one type per line. Blank lines and lines starting with
+ * '#' are ignored.
+ *
+ *   <type_name> <like_type> [<field> <value>]...
+ *
+ * The new type starts out with the class and parameters of like_type, which may
+ * be any type already defined, and then sets each field listed, e.g.
+ *
+ *   Heavy_cruiser Cruiser maximum_speed 15 resistance 12 firepower 5
+ *
+ * Defining a type that already exists replaces its parameters. The fuel capacity
+ * and maximum speed must be positive, and the other fields must not be negative.
+ */
+
+struct Ship_parameters {
+    std::string type_name;      // The type given to the "create" command
+    std::string class_name;     // The built-in type whose behavior the ships have
+    double fuel_capacity;       // Amount of fuel the ship can hold, tons
+    double maximum_speed;       // Maximum speed of the ship, nm/hr
+    double fuel_consumption;    // Fuel used per nm travelled, tons/nm
+    int resistance;             // Resistance to damage
+    int firepower;              // Damage done per hit, Warships only
+    double attack_range;        // Maximum distance of an attack, Warships only
+};
+
+// Get the current parameters for ships of type `type`.
+// May throw Error("Trying to create ship of unknown type!")
+const Ship_parameters& get_ship_parameters(const std::string& type);
+
+// Return the current parameters for ships of type `type`, or nullptr if there
+// is no such type
+const Ship_parameters* find_ship_parameters(const std::string& type);
+
+// Return the block that the built-in type of class class_name started out with,
+// or nullptr if class_name is not a built-in class
+const Ship_parameters* find_class_parameters(const std::string& class_name);
+
+// Return true if the fuel capacity and maximum speed are positive and the other
+// fields are not negative
+bool has_valid_values(const Ship_parameters& parameters);
+
+// Return a block with the same values as parameters, which is the current block
+// of its type if that has the same values, or else a new one
+const Ship_parameters* intern_ship_parameters(const Ship_parameters& parameters);
+
+// Make parameters the current parameters of its type, adding the type if it is new
+void define_ship_type(const Ship_parameters& parameters);
+
+// Return the current parameters of every type, in type name order
+std::vector<const Ship_parameters*> get_ship_types();
+
+// Change a single parameter for ships of type `type`. `parameter` is the name of
+// one of the numeric Ship_parameters fields, e.g. "firepower". Integer fields are
+// rounded to the nearest integer.
+// May throw Error("Trying to create ship of unknown type!") or
+// Error("Unknown ship parameter!")
+void set_ship_parameter(const std::string& type, const std::string& parameter,
+        double value);
+
+// Define the types in a ship types file, see above. The types are only defined
+// once the whole file has been read.
+// May throw Error("Could not open ship types file!") or Error("Invalid ship types file!")
+void load_ship_types(const std::string& file_name);
+
+// Return the number of parameter blocks ever made, and the bytes used by them and
+// the registry
+std::size_t get_ship_parameter_block_count();
+std::size_t get_ship_parameters_memory_size();
+
+// Write and read the values of a parameter block
+void save_ship_parameters(Snapshot_writer& writer, const Ship_parameters& parameters);
+Ship_parameters restore_ship_parameters(Snapshot_reader& reader);
+
+#endif
@@ -0,0 +1,106 @@
+#include "Ship_selection.h"
+
+#include "Utility.h"
+#include "Spill.h"
+
+#include <iostream>
+#include <functional>
+
+using namespace std;
+using namespace placeholders;
+
+/* Templated private member functions */
+
+// Loop through all ships, apply the provided function, and if an error occurs,
+// print out the ship's name and the error message, but continue the loop.
+template <typename T>
+void Ship_selection::for_each_ship_catch(T func) const {
+    for (auto& ship_ptr : ships) {
+        try {
+            func(ship_ptr);
+        } catch (Error& e) {
+            cout << ship_ptr->get_name() << ": " << e.what() << endl;
+        }
+    }
+}
+
+/* Public member functions */
+
+// A selection has no name of its own
+Ship_selection::Ship_selection(vector<shared_ptr<Ship_component>> ships_) :
+        Ship_component(""), ships(move(ships_)) { }
+
+// A selection doesn't have a location
+Point Ship_selection::get_location() const {
+    throw Error("Is not an individual!");
+}
+
+/* Command functions */
+// All command functions call the corresponding command function on all ships
+// using the for_each_ship_catch() helper function.
+
+void Ship_selection::set_destination_position_and_speed(
+        Point destination_position, double speed) {
+    for_each_ship_catch(
+            bind(&Ship_component::set_destination_position_and_speed, _1,
+                    destination_position, speed));
+}
+
+void Ship_selection::set_destination_island_and_speed(
+        shared_ptr<Island> destination_island, double speed) {
+    for_each_ship_catch(
+            bind(&Ship_component::set_destination_island_and_speed, _1,
+                    destination_island, speed));
+}
+
+void Ship_selection::set_course_and_speed(double course, double speed) {
+    for_each_ship_catch(
+            bind(&Ship_component::set_course_and_speed, _1, course, speed));
+}
+
+void Ship_selection::stop() {
+    for_each_ship_catch(mem_fn(&Ship_component::stop));
+}
+
+void Ship_selection::dock(shared_ptr<Island> island_ptr) {
+    for_each_ship_catch(bind(&Ship_component::dock, _1, island_ptr));
+}
+
+void Ship_selection::refuel() {
+    for_each_ship_catch(mem_fn(&Ship_component::refuel));
+}
+
+// Is not implemented since unrelated ships should not be able to receive a hit
+// from a single source.
+void Ship_selection::receive_hit(int, shared_ptr<Ship_component>) {
+    throw Error("A group can't take a hit!");
+}
+
+void Ship_selection::set_load_destination(shared_ptr<Island> island_ptr) {
+    for_each_ship_catch(
+            bind(&Ship_component::set_load_destination, _1, island_ptr));
+}
+
+void Ship_selection::set_unload_destination(shared_ptr<Island> island_ptr) {
+    for_each_ship_catch(
+            bind(&Ship_component::set_unload_destination, _1, island_ptr));
+}
+
+void Ship_selection::attack(shared_ptr<Ship_component> target_ptr) {
+    for_each_ship_catch(bind(&Ship_component::attack, _1, target_ptr));
+}
+
+void Ship_selection::stop_attack() {
+    for_each_ship_catch(mem_fn(&Ship_component::stop_attack));
+}
+
+// The strips are only assigned once every ship has joined
+void Ship_selection::start_skimming(Point spill_origin_, int spill_size_) {
+    auto spill_ptr = make_shared<Spill>(spill_origin_, spill_size_);
+    join_spill(spill_ptr);
+    spill_ptr->assign_strips();
+}
+
+void Ship_selection::join_spill(shared_ptr<Spill> spill_ptr) {
+    for_each_ship_catch(bind(&Ship_component::join_spill, _1, spill_ptr));
+}
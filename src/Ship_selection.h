@@ -0,0 +1,71 @@
+#ifndef SHIP_SELECTION_H
+#define SHIP_SELECTION_H
+
+#include "Ship_component.h"
+
+#include <vector>
+#include <memory>
+
+/* Ship_selection class
+ *
+ * A Ship_selection is a temporary set of ships picked out by the "fleet" command,
+ * so that one ship command can be given to all of them at once.
+ *
+ * Like a Ship_group it passes each command on to every ship, printing the error of
+ * any ship that can't carry it out and going on with the rest. Unlike a Ship_group
+ * it is not part of the Model, does not become the parent of its ships, and only
+ * lives as long as the command that created it. It has no location, does nothing
+ * when updated, and is never saved.
+ */
+
+class Ship_selection : public Ship_component {
+public:
+    // Select the ships, which are commanded in the order given
+    Ship_selection(std::vector<std::shared_ptr<Ship_component>> ships_);
+
+    // A selection doesn't have a location, throw an error
+    Point get_location() const override;
+
+    // A selection is never in the Model, so these do nothing
+    void update() override { }
+    void describe() const override { }
+    void broadcast_current_state() const override { }
+    void save_state(Snapshot_writer&) const override { }
+    void restore_state(Snapshot_reader&) override { }
+    std::size_t get_memory_size() const override
+        { return sizeof(Ship_selection); }
+
+    const char* get_type_name() const override
+        { return "Selection"; }
+    const char* get_class_name() const override
+        { return "Selection"; }
+
+    /*** Command functions ***/
+    // Each of these functions calls the corresponding function on all ships
+    void set_destination_position_and_speed(Point destination_position,
+            double speed) override;
+    void set_destination_island_and_speed(
+            std::shared_ptr <Island> destination_island, double speed) override;
+    void set_course_and_speed(double course, double speed) override;
+    void stop() override;
+    void dock(std::shared_ptr<Island> island_ptr) override;
+    void refuel() override;
+    // A selection of unrelated ships can't take a single hit, throws an error
+    void receive_hit(int hit_force, std::shared_ptr<Ship_component> attacker_ptr) override;
+    void set_load_destination(std::shared_ptr<Island> island_ptr) override;
+    void set_unload_destination(std::shared_ptr<Island> island_ptr) override;
+    void attack(std::shared_ptr<Ship_component> target_ptr) override;
+    void stop_attack() override;
+    // The skimmers share the spill, each skimming a strip of it, see Spill.h
+    void start_skimming(Point spill_origin_, int spill_size_) override;
+    void join_spill(std::shared_ptr<Spill> spill_ptr) override;
+
+private:
+    std::vector<std::shared_ptr<Ship_component>> ships;
+
+    // Call func on every ship, printing the error of any ship that fails
+    template <typename T>
+    void for_each_ship_catch(T func) const;
+};
+
+#endif
@@ -1,8 +1,32 @@
 #include "Sim_object.h"
 
+#include "Utility.h"
+
 #include <string>
+#include <unordered_set>
 
 using std::string;
+using std::unordered_set;
+
+// The table of the names of every object ever made
+static unordered_set<string>& get_name_table() {
+    static unordered_set<string> names;
+    return names;
+}
 
 // Construct a new Sim_object by populating the name field
-Sim_object::Sim_object(const string &name_) : name(name_) { }
+Sim_object::Sim_object(const string &name_) :
+    name(&*get_name_table().insert(name_).first) { }
+
+std::size_t Sim_object::get_name_count() {
+    return get_name_table().size();
+}
+
+// The nodes of the table and the long names that don't fit in a string
+std::size_t Sim_object::get_names_memory_size() {
+    auto& names = get_name_table();
+    std::size_t size = get_hash_table_memory_size(names);
+    for (auto& name : names)
+        size += get_string_memory_size(name);
+    return size;
+}
@@ -2,10 +2,17 @@
 #define SIM_OBJECT_H
 /* This class provides the interface for all of simulation objects. It also stores the
 object's name, and has pure virtual accessor functions for the object's position
-and other information. */
+and other information.
+
+The names are kept in a table shared by all of the objects, and each object only
+points to its name. Names are never taken out of the table, so the pointers stay
+good, and an object made with the name of one that was removed shares its string. */
 
 #include <string>
+#include <cstddef>
 struct Point;
+class Snapshot_writer;
+class Snapshot_reader;
 
 class Sim_object {
 public:
@@ -17,7 +24,7 @@ public:
     virtual ~Sim_object() = default;
 	
 	const std::string& get_name() const
-		{return name;}
+		{return *name;}
     
 	/* Interface for derived classes */
 	// ask model to notify views of current state
@@ -25,6 +32,20 @@ public:
 	virtual Point get_location() const = 0;
 	virtual void describe() const = 0;
 	virtual void update() = 0;
+
+	// Write the object's state to a snapshot, and read it back in the same order.
+	// References to other objects are resolved by the reader, so they must
+	// already exist when restore_state is called.
+	virtual void save_state(Snapshot_writer& writer) const = 0;
+	virtual void restore_state(Snapshot_reader& reader) = 0;
+
+	// Return the bytes used by the object and the memory that it alone owns. The
+	// name and memory shared with other objects are not counted.
+	virtual std::size_t get_memory_size() const = 0;
+
+	// Return the number of names in the table and the bytes it uses
+	static std::size_t get_name_count();
+	static std::size_t get_names_memory_size();
 	
 	// Sim_objects must be unique, so disable copy/move construction, assignment
     // of base class; this will disable these operations for derived classes also.
@@ -34,7 +55,7 @@ public:
 	Sim_object& operator= (const Sim_object&&) = delete;
 
 private:
-	std::string name; // The name of the object
+	const std::string* name; // The name of the object, in the table of names
 };
 
 
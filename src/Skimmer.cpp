@@ -1,16 +1,12 @@
 #include "Skimmer.h"
 #include "Utility.h"
+#include "Snapshot.h"
 
 #include <iostream>
 #include <cassert>
 
 using namespace std;
 
-const double skimmer_fuel_capacity_c = 100.;
-const double skimmer_maximum_speed_c = 3.;
-const double skimmer_fuel_consumption_c = 0.5;
-const int skimmer_resistance_c = 0;
-
 /* Tracking the Skimming State
  * We track where we are in the state of skimming the requested area by
  * keeping track of how many sides of the spiral we still need to skim.
@@ -21,24 +17,35 @@ const int skimmer_resistance_c = 0;
  * Compass_vectors are not accurate enough for Map_view, so for
  * cardinal directions just add the value directly to the current position
  * rather than constructing a Compass_vector.
+ *
+ * A skimmer given a strip of a shared spill sweeps north up the strip's first
+ * column, then crosses 2 nm east along the north edge and sweeps south down the
+ * second column, which is then to starboard, and sweeps north again up the third
+ * column from the same line, and so on until every column of the strip is done.
  */
 
 // Construct a skimmer object
-Skimmer::Skimmer(const string &name_, Point position_) :
-        Ship(name_, position_, skimmer_fuel_capacity_c,
-                skimmer_maximum_speed_c, skimmer_fuel_consumption_c,
-                skimmer_resistance_c),
-        skimming_state(SkimmingState_t::not_skimming) { }
+Skimmer::Skimmer(const string &name_, Point position_,
+        const Ship_parameters* parameters_) :
+        Ship(name_, position_, parameters_),
+        skimming_state(SkimmingState_t::not_skimming),
+        additional_sides_to_skim(0) { }
 
 // Describe the skimming object
 void Skimmer::describe() const {
-    cout << "\nSkimmer ";
+    cout << "\n" << get_type_name() << " ";
     Ship::describe();
     if (skimming_state == SkimmingState_t::going_to_spill) {
         cout << "Going to spill" << endl;
+    } else if (is_skimming_strip()) {
+        cout << "Is skimming part of a spill of size " << spill->get_size() <<
+                " starting at " << spill->get_sw_corner() << ", " <<
+                additional_sides_to_skim << " columns left" << endl;
+        cout << "Spill is " << spill->get_fraction_skimmed() * 100. <<
+                "% skimmed, about " << spill->get_hours_left() << " hours left" << endl;
     } else if (is_skimming()) {
-        cout << "Is skimming a spill of size " << spill_size <<
-                " starting at " << spill_sw_corner << endl;
+        cout << "Is skimming a spill of size " << spill->get_size() <<
+                " starting at " << spill->get_sw_corner() << endl;
     }
 }
 
@@ -46,10 +53,15 @@ void Skimmer::describe() const {
 // square with the size change every spiral being 2 nm (1 nm per half spiral).
 // This gives us a spiral with 1 nm between the course path and itself as it
 // spirals inwards TODO clear up wording
+// Whatever we passed over while skimming is marked on the spill.
 void Skimmer::update() {
+    bool sweeping = is_sweeping();
+    Point old_location = get_location();
     Ship::update();
     if (!is_skimming())
         return;
+    if (sweeping)
+        spill->sweep(old_location, get_location());
     if (!can_move()) {
         reset_skimming_state();
         return;
@@ -59,6 +71,11 @@ void Skimmer::update() {
     if (is_moving())
         return;
 
+    if (is_skimming_strip()) {
+        continue_strip();
+        return;
+    }
+
     // If we have finished our spiral, stop skimming.
     if (additional_sides_to_skim == 0) {
         cout << get_name() << " finished skimming spill" << endl;
@@ -132,27 +149,72 @@ void Skimmer::set_course_and_speed(double course, double speed) {
 void Skimmer::start_skimming(Point spill_sw_corner_, int spill_size_) {
     if (!can_move())
         throw Error("Can't move!");
-    if (spill_size_ <= 0)
-        throw Error("Spill size can't be zero or negative!");
+    auto new_spill = make_shared<Spill>(spill_sw_corner_, spill_size_);
 
     // Set up the skimming state
-    spill_sw_corner = spill_sw_corner_;
-    spill_size = spill_size_;
+    reset_skimming_state();
+    spill = new_spill;
+    spill->add_skimmer(static_pointer_cast<Skimmer>(shared_from_this()));
     skimming_state = SkimmingState_t::going_to_spill;
     // Calculate the number of sides that we will have to travel in the spiral.
     // We will use this as a counter to keep track of where we are in the spiral
     // pattern and where we need to go to next
-    additional_sides_to_skim = spill_size * 2 - 1;
+    additional_sides_to_skim = spill_size_ * 2 - 1;
 
     // Travel to the south west corner of the spill
     Ship::set_destination_position_and_speed(spill_sw_corner_, get_maximum_speed());
 }
 
+// Make sure we can move, then wait for our strip
+void Skimmer::join_spill(shared_ptr<Spill> spill_ptr) {
+    if (!can_move())
+        throw Error("Can't move!");
+    spill_ptr->join(static_pointer_cast<Skimmer>(shared_from_this()));
+}
+
+// Head for the south end of the strip's first column
+void Skimmer::skim_strip(shared_ptr<Spill> spill_ptr, int first_column, int column_count) {
+    if (column_count <= 0) {
+        cout << get_name() << " has no part of the spill to skim" << endl;
+        return;
+    }
+    reset_skimming_state();
+    spill = spill_ptr;
+    spill->add_skimmer(static_pointer_cast<Skimmer>(shared_from_this()));
+    skimming_state = SkimmingState_t::going_to_strip;
+    additional_sides_to_skim = column_count;
+    Point strip_start = spill->get_sw_corner();
+    strip_start.x += first_column;
+    Ship::set_destination_position_and_speed(strip_start, get_maximum_speed());
+}
+
+// Save the skimming state, including how far along the spiral or strip we are,
+// and the spill
+void Skimmer::save_state(Snapshot_writer& writer) const {
+    Ship::save_state(writer);
+    writer.write_int(static_cast<int>(skimming_state));
+    writer.write_int(additional_sides_to_skim);
+    if (spill)
+        spill->save(writer);
+}
+
+// Restore the skimming state, and go back to work on the spill
+void Skimmer::restore_state(Snapshot_reader& reader) {
+    Ship::restore_state(reader);
+    skimming_state = static_cast<SkimmingState_t>(reader.read_int());
+    additional_sides_to_skim = reader.read_int();
+    spill.reset();
+    if (is_skimming()) {
+        spill = Spill::restore(reader);
+        spill->add_skimmer(static_pointer_cast<Skimmer>(shared_from_this()));
+    }
+}
+
 // Skim the first side of the spill, which has 1 nm less distance of travel than
 // we would normally calculate based on the side number of sides left to skim.
 void Skimmer::skim_first_side() {
     Point new_dest = get_location();
-    new_dest.y += spill_size;
+    new_dest.y += spill->get_size();
     skimming_state = SkimmingState_t::going_north;
     --additional_sides_to_skim;
     Ship::set_destination_position_and_speed(new_dest, get_maximum_speed());
@@ -160,7 +222,41 @@ void Skimmer::skim_first_side() {
 
 // Reset the state of the object
 void Skimmer::reset_skimming_state() {
+    if (spill)
+        spill->remove_skimmer(this);
+    spill.reset();
     skimming_state = SkimmingState_t::not_skimming;
-    spill_size = 0;
-    spill_sw_corner = {0., 0.};
+}
+
+// A north or south sweep finishes a column
+void Skimmer::continue_strip() {
+    Point new_dest = get_location();
+    switch (skimming_state) {
+    case SkimmingState_t::going_to_strip:
+        skimming_state = SkimmingState_t::sweeping_north;
+        new_dest.y += spill->get_size();
+        break;
+    case SkimmingState_t::sweeping_north:
+    case SkimmingState_t::sweeping_south:
+        if (--additional_sides_to_skim == 0) {
+            cout << get_name() << " finished skimming its part of the spill" << endl;
+            reset_skimming_state();
+            return;
+        }
+        if (skimming_state == SkimmingState_t::sweeping_north) {
+            skimming_state = SkimmingState_t::crossing_east;
+            new_dest.x += 2;
+        } else {
+            skimming_state = SkimmingState_t::sweeping_north;
+            new_dest.y += spill->get_size();
+        }
+        break;
+    case SkimmingState_t::crossing_east:
+        skimming_state = SkimmingState_t::sweeping_south;
+        new_dest.y -= spill->get_size();
+        break;
+    default:
+        assert(0);
+    }
+    Ship::set_destination_position_and_speed(new_dest, get_maximum_speed());
 }
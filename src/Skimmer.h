@@ -2,6 +2,7 @@
 #define PIRATE_SHIP_H
 
 #include "Ship.h"
+#include "Spill.h"
 
 /* Skimmer class
  * A skimmer is meant to simulate the job of an oil skimmer that cleans up oil on the
@@ -17,16 +18,28 @@
  *
  * If the skimmer is told to stop or is given another order, it stops skimming and
  * will follow the new order immediately.
+ *
+ * Several skimmers can share the work of one spill, see Spill.h. Each joins the
+ * spill, and is then given a strip of the spill's columns, which it sweeps north
+ * up one column and south down the next until the strip is done. Describing such
+ * a skimmer shows how much of the spill has been skimmed and an estimate of the
+ * time left.
  */
 
 class Skimmer : public Ship {
 public:
     // Construct a skimmer object
-    Skimmer(const std::string& name_, Point position_);
+    Skimmer(const std::string& name_, Point position_,
+            const Ship_parameters* parameters_);
+
 
     // Describe the skimmer
     void describe() const override;
 
+    // Bytes used by the skimmer
+    std::size_t get_memory_size() const override
+        { return sizeof(Skimmer) + Ship::get_memory_size(); }
+
     // Update the skimmer, and simulate the circular path if we are
     // currently skimming
     void update() override;
@@ -47,17 +60,42 @@ public:
 
     // Start skimming at the south-west corner of a spill of size spill_size_.
     void start_skimming(Point spill_sw_corner_, int spill_size_) override;
+
+    // Join the skimmers that will share spill_ptr
+    // may throw Error("Can't move!")
+    void join_spill(std::shared_ptr<Spill> spill_ptr) override;
+
+    // Skim column_count columns of spill_ptr starting with first_column, counted
+    // from the west. Called by Spill::assign_strips().
+    void skim_strip(std::shared_ptr<Spill> spill_ptr, int first_column, int column_count);
+
+    // Save and restore the skimming state along with the Ship state
+    void save_state(Snapshot_writer& writer) const override;
+    void restore_state(Snapshot_reader& reader) override;
 private:
     enum class SkimmingState_t {not_skimming, going_to_spill, going_north,
-        going_east, going_south, going_west} skimming_state;
-    int spill_size;
-    Point spill_sw_corner;
+        going_east, going_south, going_west, going_to_strip, sweeping_north,
+        crossing_east, sweeping_south} skimming_state;
+    std::shared_ptr<Spill> spill;   // The spill we are skimming, if any
+    // Sides of the spiral left, or columns of the strip left
     int additional_sides_to_skim;
 
     // See if we are currently skimming or not
     bool is_skimming() const
         {return skimming_state != SkimmingState_t::not_skimming;};
 
+    // See if we are skimming a strip of a shared spill
+    bool is_skimming_strip() const
+        {return skimming_state >= SkimmingState_t::going_to_strip;}
+
+    // See if we skim the spill as we move
+    bool is_sweeping() const
+        {return is_skimming() && skimming_state != SkimmingState_t::going_to_spill &&
+            skimming_state != SkimmingState_t::going_to_strip;}
+
+    // Start the next leg of the strip, or finish the strip
+    void continue_strip();
+
     // Skim the first side of the spill since it needs to be specially handled
     void skim_first_side();
 
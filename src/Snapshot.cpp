@@ -0,0 +1,122 @@
+#include "Snapshot.h"
+
+#include "Island.h"
+#include "Ship_component.h"
+#include "Utility.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/* Snapshot_writer */
+
+// Write the length of the string followed by its characters
+void Snapshot_writer::write_string(const string& s) {
+    write_int(static_cast<int>(s.size()));
+    data.append(s);
+}
+
+// Write the island's name, or an empty name if there is no island
+void Snapshot_writer::write_island(const shared_ptr<Island>& island_ptr) {
+    write_string(island_ptr ? island_ptr->get_name() : string());
+}
+
+// Write the ship's name, or an empty name if there is no ship
+void Snapshot_writer::write_ship(const shared_ptr<Ship_component>& ship_ptr) {
+    write_string(ship_ptr ? ship_ptr->get_name() : string());
+}
+
+// Shared objects are numbered in the order they are first written
+bool Snapshot_writer::write_shared_id(const void* ptr) {
+    auto inserted = shared_ids.insert({ptr, static_cast<int>(shared_ids.size())});
+    write_int(inserted.first->second);
+    return inserted.second;
+}
+
+/* Snapshot_reader */
+
+Snapshot_reader::Snapshot_reader(const char* begin_, const char* end_) :
+        current(begin_), end(end_) { }
+
+// Read a string written by Snapshot_writer::write_string
+string Snapshot_reader::read_string() {
+    int length = read_int();
+    if (length < 0)
+        throw Error("Invalid snapshot file!");
+    const char* chars = read_bytes(length);
+    return string(chars, length);
+}
+
+// Read an island name and look up the island it refers to
+shared_ptr<Island> Snapshot_reader::read_island() {
+    string name = read_string();
+    if (name.empty())
+        return nullptr;
+    auto island_ptr = island_lookup(name);
+    if (!island_ptr)
+        throw Error("Invalid snapshot file!");
+    return island_ptr;
+}
+
+// Return the shared object read with id, or nullptr if there is none yet
+shared_ptr<void> Snapshot_reader::find_shared(int id) const {
+    auto itt = shared_objects.find(id);
+    return itt == shared_objects.end() ? nullptr : itt->second;
+}
+
+// Read a ship name and look up the ship it refers to
+shared_ptr<Ship_component> Snapshot_reader::read_ship() {
+    string name = read_string();
+    if (name.empty())
+        return nullptr;
+    auto ship_ptr = ship_lookup(name);
+    if (!ship_ptr)
+        throw Error("Invalid snapshot file!");
+    return ship_ptr;
+}
+
+void Snapshot_reader::set_lookups(Island_lookup_t island_lookup_,
+        Ship_lookup_t ship_lookup_) {
+    island_lookup = island_lookup_;
+    ship_lookup = ship_lookup_;
+}
+
+// Make sure there is enough data left, then skip over it
+const char* Snapshot_reader::read_bytes(size_t count) {
+    if (size_t(end - current) < count)
+        throw Error("Invalid snapshot file!");
+    const char* bytes = current;
+    current += count;
+    return bytes;
+}
+
+/* Mapped_file */
+
+// Map the file into memory. An empty file can't be mapped, but it is also not a
+// valid snapshot, so treat it as an error as well.
+Mapped_file::Mapped_file(const string& file_name) {
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw Error("Could not open snapshot file!");
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        throw Error("Could not open snapshot file!");
+    }
+    size = file_stat.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the file is closed
+    close(fd);
+    if (mapping == MAP_FAILED)
+        throw Error("Could not open snapshot file!");
+    // We read the whole file front to back
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(mapping);
+}
+
+Mapped_file::~Mapped_file() {
+    munmap(const_cast<char*>(data), size);
+}
@@ -0,0 +1,158 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "Geometry.h"
+
+#include <string>
+#include <memory>
+#include <functional>
+#include <map>
+#include <cstring>
+
+class Island;
+class Ship_component;
+
+/* Snapshot_writer and Snapshot_reader
+ *
+ * A snapshot is a compact binary image of the Model's state. Values are stored
+ * in the machine's native representation, so a snapshot can only be loaded on the
+ * kind of machine that saved it. Strings are stored as a length followed by the
+ * characters, and references to other objects are stored as the object's name,
+ * with an empty name for a null pointer.
+ *
+ * Each Sim_object writes its own state with save_state() and reads it back in the
+ * same order with restore_state(). The Model writes the file header and the table
+ * of objects that must be created before any state can be restored; see
+ * Model::save_snapshot() for the layout of the file.
+ *
+ * An object that is not a Sim_object but is shared by several of them, such as a
+ * spill that several skimmers work on, is written by each of them, with an id
+ * that lets the reader share it again: the first time it is written in full, and
+ * after that only its id is written.
+ *
+ * Snapshot_reader reads directly from memory, normally a memory-mapped file, and
+ * throws Error("Invalid snapshot file!") if it runs past the end of the data or
+ * finds a reference to an object that does not exist.
+ */
+
+class Snapshot_writer {
+public:
+    void write_int(int i)
+        { write_raw(i); }
+    void write_double(double d)
+        { write_raw(d); }
+    void write_bool(bool b)
+        { write_raw(static_cast<char>(b)); }
+    void write_point(Point p)
+        { write_raw(p.x); write_raw(p.y); }
+    void write_string(const std::string& s);
+
+    // Write a reference to an object as its name, or an empty name if null
+    void write_island(const std::shared_ptr<Island>& island_ptr);
+    void write_ship(const std::shared_ptr<Ship_component>& ship_ptr);
+
+    // Write the id of a shared object, returning true if it is the first time it
+    // is written, in which case the object must be written in full after the id
+    bool write_shared_id(const void* ptr);
+
+    // Return everything written so far
+    const std::string& get_data() const
+        { return data; }
+
+private:
+    std::string data;
+    std::map<const void*, int> shared_ids;
+
+    template <typename T>
+    void write_raw(const T& value)
+        { data.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+};
+
+class Snapshot_reader {
+public:
+    // Functions used to turn a name back into an object reference
+    using Island_lookup_t = std::function<std::shared_ptr<Island> (const std::string&)>;
+    using Ship_lookup_t = std::function<std::shared_ptr<Ship_component> (const std::string&)>;
+
+    // Read from the memory in [begin, end)
+    Snapshot_reader(const char* begin_, const char* end_);
+
+    int read_int()
+        { return read_raw<int>(); }
+    double read_double()
+        { return read_raw<double>(); }
+    bool read_bool()
+        { return read_raw<char>() != 0; }
+    Point read_point()
+        { double x = read_raw<double>(); double y = read_raw<double>(); return {x, y}; }
+    std::string read_string();
+
+    // Read a reference written by Snapshot_writer::write_island or write_ship,
+    // returns nullptr for a null reference.
+    std::shared_ptr<Island> read_island();
+    std::shared_ptr<Ship_component> read_ship();
+
+    // Read the id of a shared object, then look up the object already read with
+    // that id. If there is none, the object follows in full, and must be added
+    // once it has been read.
+    int read_shared_id()
+        { return read_int(); }
+    std::shared_ptr<void> find_shared(int id) const;
+    void add_shared(int id, std::shared_ptr<void> ptr)
+        { shared_objects[id] = std::move(ptr); }
+
+    // Set the functions used to look up object references
+    void set_lookups(Island_lookup_t island_lookup_, Ship_lookup_t ship_lookup_);
+
+    // Return true if all of the data has been read
+    bool at_end() const
+        { return current == end; }
+
+    // Read and check that count bytes are available, returning a pointer to them
+    const char* read_bytes(size_t count);
+
+private:
+    const char* current;
+    const char* end;
+    Island_lookup_t island_lookup;
+    Ship_lookup_t ship_lookup;
+    std::map<int, std::shared_ptr<void>> shared_objects;
+
+    template <typename T>
+    T read_raw();
+};
+
+// Copy a value out of the data, which may not be aligned for T
+template <typename T>
+T Snapshot_reader::read_raw() {
+    T value;
+    std::memcpy(&value, read_bytes(sizeof(T)), sizeof(T));
+    return value;
+}
+
+/* Mapped_file
+ * Maps a whole file read-only into memory for the lifetime of the object.
+ * May throw Error("Could not open snapshot file!")
+ */
+class Mapped_file {
+public:
+    Mapped_file(const std::string& file_name);
+    ~Mapped_file();
+
+    const char* begin() const
+        { return data; }
+    const char* end() const
+        { return data + size; }
+
+    // disallow copy/move construction or assignment
+    Mapped_file(const Mapped_file&) = delete;
+    Mapped_file(const Mapped_file&&) = delete;
+    Mapped_file& operator= (const Mapped_file&) = delete;
+    Mapped_file& operator= (const Mapped_file&&) = delete;
+
+private:
+    const char* data;
+    size_t size;
+};
+
+#endif
@@ -0,0 +1,145 @@
+#include "Spill.h"
+
+#include "Skimmer.h"
+#include "Snapshot.h"
+#include "Utility.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+// Distance between the points along a skimmer's path where the cell to starboard
+// is marked, short enough that no cell is missed
+const double sweep_sample_spacing_c = 0.5;
+
+// Construct a spill with none of it skimmed
+Spill::Spill(Point sw_corner_, int spill_size_) :
+        sw_corner(sw_corner_), spill_size(spill_size_) {
+    if (spill_size <= 0)
+        throw Error("Spill size can't be zero or negative!");
+    if (spill_size > spill_size_max_c)
+        throw Error("Spill size is too large!");
+    skimmed.assign(static_cast<size_t>(spill_size) * spill_size, false);
+}
+
+// The path is sampled at the middle of equal pieces of it, and the cell half a nm
+// to starboard of each sample is marked. The direction to starboard is the
+// direction of travel turned 90 degrees clockwise.
+void Spill::sweep(Point from, Point to) {
+    Cartesian_vector displacement(from, to);
+    double distance = cartesian_distance(from, to);
+    if (distance == 0.)
+        return;
+    double starboard_x = displacement.delta_y / distance;
+    double starboard_y = -displacement.delta_x / distance;
+    int sample_count = static_cast<int>(ceil(distance / sweep_sample_spacing_c));
+    for (int i = 0; i < sample_count; ++i) {
+        double fraction = (i + 0.5) / sample_count;
+        double x = from.x + displacement.delta_x * fraction + starboard_x / 2. - sw_corner.x;
+        double y = from.y + displacement.delta_y * fraction + starboard_y / 2. - sw_corner.y;
+        if (x < 0. || y < 0. || x >= spill_size || y >= spill_size)
+            continue;
+        size_t cell = static_cast<size_t>(floor(y)) * spill_size + static_cast<size_t>(floor(x));
+        if (!skimmed[cell]) {
+            skimmed[cell] = true;
+            ++skimmed_count;
+        }
+    }
+}
+
+double Spill::get_fraction_skimmed() const {
+    return static_cast<double>(skimmed_count) / skimmed.size();
+}
+
+// Each cell is 1 nm^2, so a skimmer skims as many cells an hour as its maximum
+// speed. Only the skimmers that are still afloat are counted.
+double Spill::get_hours_left() const {
+    double sweep_rate = 0.;
+    for (auto& skimmer_weak_ptr : working_skimmers) {
+        auto skimmer_ptr = skimmer_weak_ptr.lock();
+        if (skimmer_ptr && skimmer_ptr->is_afloat())
+            sweep_rate += skimmer_ptr->get_maximum_speed();
+    }
+    if (sweep_rate <= 0.)
+        return -1.;
+    return (skimmed.size() - skimmed_count) / sweep_rate;
+}
+
+// Skimmers that no longer exist are dropped along the way
+void Spill::add_skimmer(shared_ptr<Skimmer> skimmer_ptr) {
+    remove_skimmer(skimmer_ptr.get());
+    working_skimmers.push_back(skimmer_ptr);
+}
+
+void Spill::remove_skimmer(const Skimmer* skimmer_ptr) {
+    working_skimmers.erase(remove_if(working_skimmers.begin(), working_skimmers.end(),
+            [skimmer_ptr](const weak_ptr<Skimmer>& skimmer_weak_ptr) {
+                auto locked_ptr = skimmer_weak_ptr.lock();
+                return !locked_ptr || locked_ptr.get() == skimmer_ptr;
+            }), working_skimmers.end());
+}
+
+// Keep the skimmer until the strips are assigned
+void Spill::join(shared_ptr<Skimmer> skimmer_ptr) {
+    joined_skimmers.push_back(skimmer_ptr);
+}
+
+// The first columns % skimmers strips are a column wider than the others
+void Spill::assign_strips() {
+    vector<shared_ptr<Skimmer>> skimmers;
+    for (auto& skimmer_ptr : joined_skimmers) {
+        if (auto locked_ptr = skimmer_ptr.lock())
+            skimmers.push_back(locked_ptr);
+    }
+    joined_skimmers.clear();
+    if (skimmers.empty())
+        return;
+
+    int skimmer_count = static_cast<int>(skimmers.size());
+    int first_column = 0;
+    for (int i = 0; i < skimmer_count; ++i) {
+        int column_count = spill_size / skimmer_count + (i < spill_size % skimmer_count);
+        skimmers[i]->skim_strip(shared_from_this(), first_column, column_count);
+        first_column += column_count;
+    }
+}
+
+// The cells are packed eight to a byte
+void Spill::save(Snapshot_writer& writer) const {
+    if (!writer.write_shared_id(this))
+        return;
+    writer.write_point(sw_corner);
+    writer.write_int(spill_size);
+    string bits((skimmed.size() + 7) / 8, '\0');
+    for (size_t cell = 0; cell < skimmed.size(); ++cell) {
+        if (skimmed[cell])
+            bits[cell / 8] |= static_cast<char>(1 << (cell % 8));
+    }
+    writer.write_string(bits);
+}
+
+// The skimmers working on the spill add themselves again as they are restored.
+// The size and the bits are checked against each other before the bitmap is made.
+shared_ptr<Spill> Spill::restore(Snapshot_reader& reader) {
+    int id = reader.read_shared_id();
+    if (auto found_ptr = reader.find_shared(id))
+        return static_pointer_cast<Spill>(found_ptr);
+    Point sw_corner = reader.read_point();
+    int spill_size = reader.read_int();
+    if (spill_size <= 0 || spill_size > spill_size_max_c)
+        throw Error("Invalid snapshot file!");
+    string bits = reader.read_string();
+    size_t cell_count = static_cast<size_t>(spill_size) * spill_size;
+    if (bits.size() != (cell_count + 7) / 8)
+        throw Error("Invalid snapshot file!");
+    auto spill_ptr = make_shared<Spill>(sw_corner, spill_size);
+    for (size_t cell = 0; cell < spill_ptr->skimmed.size(); ++cell) {
+        if (bits[cell / 8] & (1 << (cell % 8))) {
+            spill_ptr->skimmed[cell] = true;
+            ++spill_ptr->skimmed_count;
+        }
+    }
+    reader.add_shared(id, spill_ptr);
+    return spill_ptr;
+}
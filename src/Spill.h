@@ -0,0 +1,88 @@
+#ifndef SPILL_H
+#define SPILL_H
+
+#include "Geometry.h"
+
+#include <vector>
+#include <memory>
+
+class Skimmer;
+class Snapshot_writer;
+class Snapshot_reader;
+
+/* Spill class
+ * A square oil spill, spill_size nm on a side with its south-west corner at
+ * sw_corner, divided into 1 nm square cells. The spill keeps a bitmap of the cells
+ * that have been skimmed, which the skimmers working on it mark as they move.
+ * The bitmap has a bit for every cell, so spills are at most spill_size_max_c nm
+ * on a side, which keeps it to a few megabytes. A
+ * skimmer's equipment reaches 1 nm off its starboard side, so it skims the cells
+ * that the 1 nm wide strip to its right passes over.
+ *
+ * Several skimmers can work on one spill together. Each joins the spill, and then
+ * assign_strips() divides the columns of cells into strips of nearly equal width,
+ * one for each skimmer from west to east, and sends each skimmer to sweep its
+ * strip. The time left is estimated from the cells not yet skimmed and the speeds
+ * of the skimmers still working on the spill. The spill only keeps weak pointers
+ * to them, and skimmers that have sunk or been destroyed no longer count, however
+ * they stopped working.
+ */
+
+// The largest spill_size of a spill
+const int spill_size_max_c = 5000;
+
+class Spill : public std::enable_shared_from_this<Spill> {
+public:
+    // Construct a spill with none of it skimmed
+    // may throw Error("Spill size can't be zero or negative!") or
+    // Error("Spill size is too large!")
+    Spill(Point sw_corner_, int spill_size_);
+
+    Point get_sw_corner() const
+        { return sw_corner; }
+    int get_size() const
+        { return spill_size; }
+
+    // Mark the cells skimmed by a skimmer moving in a straight line from `from`
+    // to `to`
+    void sweep(Point from, Point to);
+
+    // Return the fraction of the cells that have been skimmed
+    double get_fraction_skimmed() const;
+
+    // Return the estimated hours until every cell is skimmed, if the skimmers
+    // working on the spill each skim 1 nm wide at their maximum speed, or a
+    // negative number if no skimmers are working on it
+    double get_hours_left() const;
+
+    // A skimmer starts or stops working on the spill
+    void add_skimmer(std::shared_ptr<Skimmer> skimmer_ptr);
+    void remove_skimmer(const Skimmer* skimmer_ptr);
+
+    // Add a skimmer to the ones that assign_strips() divides the spill among
+    void join(std::shared_ptr<Skimmer> skimmer_ptr);
+
+    // Give each skimmer that joined a strip of columns to skim, in the order they
+    // joined. The spill must be held by a shared_ptr. If there are more skimmers
+    // than columns, the extra skimmers are given no columns.
+    void assign_strips();
+
+    // Write the spill, and read it back. The spill is written in full only the
+    // first time in a snapshot, so skimmers that shared it share it again.
+    void save(Snapshot_writer& writer) const;
+    static std::shared_ptr<Spill> restore(Snapshot_reader& reader);
+
+private:
+    Point sw_corner;
+    int spill_size;
+    // Whether each cell has been skimmed, by rows from the south, and in each row
+    // by columns from the west
+    std::vector<bool> skimmed;
+    int skimmed_count = 0;
+    // The skimmers working on the spill
+    std::vector<std::weak_ptr<Skimmer>> working_skimmers;
+    // The skimmers waiting for assign_strips()
+    std::vector<std::weak_ptr<Skimmer>> joined_skimmers;
+};
+
+#endif
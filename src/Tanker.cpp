@@ -1,24 +1,21 @@
 #include "Tanker.h"
 #include "Utility.h"
 #include "Island.h"
+#include "Snapshot.h"
 
 #include <iostream>
 #include <map>
 
 using namespace std;
 
-const double tanker_fuel_capacity_c = 100.;
-const double tanker_maximum_speed_c = 10.;
-const double tanker_fuel_consumption_c = 2.;
-const int tanker_resistance_c = 0;
 const double tanker_cargo_capacity_c = 1000.;
 
 /* Public member functions */
 
 // Construct a new tanker
-Tanker::Tanker(const string &name_, Point position_) :
-        Ship(name_, position_, tanker_fuel_capacity_c, tanker_maximum_speed_c,
-                tanker_fuel_consumption_c, tanker_resistance_c),
+Tanker::Tanker(const string &name_, Point position_,
+        const Ship_parameters* parameters_) :
+        Ship(name_, position_, parameters_),
         tanker_state(TankerState_t::no_cargo_dest), cargo(0.) { }
 
 // Set destination as long as we aren't hauling cargo
@@ -112,8 +109,13 @@ void Tanker::update() {
             tanker_state = TankerState_t::moving_to_unloading;
         } else {
             // Continue to load cargo at the island until the cargo bay is full
-            cargo += loading_island->provide_fuel(fuel_needed_to_fill_cargo);
-            cout << get_name() << " now has " << cargo << " of cargo" << endl;
+            auto this_tanker_ptr = static_pointer_cast<Tanker>(shared_from_this());
+            loading_island->request_fuel(this_tanker_ptr, fuel_needed_to_fill_cargo,
+                    [this_tanker_ptr](double amount) {
+                        this_tanker_ptr->cargo += amount;
+                        cout << this_tanker_ptr->get_name() << " now has " <<
+                                this_tanker_ptr->cargo << " of cargo" << endl;
+                    });
         }
         break;
     case TankerState_t::unloading:
@@ -140,7 +142,7 @@ void Tanker::describe() const {
             {TankerState_t::moving_to_loading, ", moving to loading destination"},
             {TankerState_t::moving_to_unloading, ", moving to unloading destination"}
     };
-    cout << "\nTanker ";
+    cout << "\n" << get_type_name() << " ";
     Ship::describe();
     cout << "Cargo: " << cargo << " tons" << describe_map[tanker_state] << endl;
 }
@@ -158,6 +160,24 @@ double Tanker::provide_fuel(double request) {
     return return_fuel;
 }
 
+// Save the cargo state
+void Tanker::save_state(Snapshot_writer& writer) const {
+    Ship::save_state(writer);
+    writer.write_int(static_cast<int>(tanker_state));
+    writer.write_double(cargo);
+    writer.write_island(loading_island);
+    writer.write_island(unloading_island);
+}
+
+// Restore the cargo state
+void Tanker::restore_state(Snapshot_reader& reader) {
+    Ship::restore_state(reader);
+    tanker_state = static_cast<TankerState_t>(reader.read_int());
+    cargo = reader.read_double();
+    loading_island = reader.read_island();
+    unloading_island = reader.read_island();
+}
+
 /* Private member functions */
 
 // Throw an error if we are hauling cargo
@@ -19,7 +19,8 @@ class Island;
 class Tanker : public Ship {
 public:
 	// initialize a tanker
-	Tanker(const std::string &name_, Point position_);
+	Tanker(const std::string &name_, Point position_,
+			const Ship_parameters* parameters_);
 
 	// This class overrides these Ship functions so that it can check if this Tanker has assigned cargo destinations.
 	// if so, throw an Error("Tanker has cargo destinations!"); otherwise, simply call the Ship functions.
@@ -48,6 +49,14 @@ public:
 	// describe the tanker
 	void describe() const override;
 
+	// Bytes used by the tanker
+	std::size_t get_memory_size() const override
+		{ return sizeof(Tanker) + Ship::get_memory_size(); }
+
+	// Save and restore the cargo state along with the Ship state
+	void save_state(Snapshot_writer& writer) const override;
+	void restore_state(Snapshot_reader& reader) override;
+
 	double provide_fuel(double request);
 private:
     enum class TankerState_t {
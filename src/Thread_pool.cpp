@@ -0,0 +1,81 @@
+#include "Thread_pool.h"
+
+using namespace std;
+
+/* Public member functions */
+
+Thread_pool::Thread_pool(int thread_count) : owner_pid(getpid()) {
+    for (int i = 1; i < thread_count; ++i)
+        workers.emplace_back(&Thread_pool::worker_loop, this);
+}
+
+Thread_pool::~Thread_pool() {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+// Start the batch, work on it alongside the workers, then wait for the tasks
+// the workers are still running.
+void Thread_pool::run(int task_count_, const function<void (int)>& task) {
+    if (getpid() != owner_pid) {
+        for (int i = 0; i < task_count_; ++i)
+            task(i);
+        return;
+    }
+
+    unique_lock<std::mutex> lock(mutex);
+    current_task = &task;
+    task_count = task_count_;
+    next_task = 0;
+    finished_tasks = 0;
+    ++batch_number;
+    work_ready.notify_all();
+
+    run_tasks(lock);
+    work_done.wait(lock, [this] { return finished_tasks == task_count; });
+    current_task = nullptr;
+
+    exception_ptr task_exception;
+    swap(task_exception, first_exception);
+    if (task_exception)
+        rethrow_exception(task_exception);
+}
+
+/* Private member functions */
+
+void Thread_pool::worker_loop() {
+    unique_lock<std::mutex> lock(mutex);
+    int last_batch = batch_number;
+    while (true) {
+        work_ready.wait(lock, [this, last_batch] {
+            return stopping || batch_number != last_batch;
+        });
+        if (stopping)
+            return;
+        last_batch = batch_number;
+        run_tasks(lock);
+    }
+}
+
+void Thread_pool::run_tasks(unique_lock<std::mutex>& lock) {
+    while (next_task < task_count) {
+        int task_index = next_task++;
+        lock.unlock();
+        exception_ptr task_exception;
+        try {
+            (*current_task)(task_index);
+        } catch (...) {
+            task_exception = current_exception();
+        }
+        lock.lock();
+        if (task_exception && !first_exception)
+            first_exception = task_exception;
+        if (++finished_tasks == task_count)
+            work_done.notify_all();
+    }
+}
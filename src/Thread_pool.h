@@ -0,0 +1,67 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+#include <unistd.h>
+
+/* Thread_pool
+ * A fixed set of worker threads that run the tasks of a batch in parallel.
+ * run() hands out the task numbers 0 to task_count - 1 to the workers and to the
+ * calling thread, and returns when every task is done. If any task throws, the
+ * first exception is rethrown by run() once the whole batch has finished.
+ *
+ * A forked copy of the process has none of the workers, so in a fork the calling
+ * thread simply runs all of the tasks itself.
+ */
+
+class Thread_pool {
+public:
+    // Start thread_count - 1 workers, the thread that calls run() is the last one
+    explicit Thread_pool(int thread_count);
+
+    // Stop and join the workers
+    ~Thread_pool();
+
+    int get_thread_count() const
+        { return static_cast<int>(workers.size()) + 1; }
+
+    // Call task(i) for each i in [0, task_count) and wait for all of them
+    void run(int task_count, const std::function<void (int)>& task);
+
+    // disallow copy/move construction or assignment
+    Thread_pool(const Thread_pool&) = delete;
+    Thread_pool(const Thread_pool&&) = delete;
+    Thread_pool& operator= (const Thread_pool&) = delete;
+    Thread_pool& operator= (const Thread_pool&&) = delete;
+
+private:
+    std::vector<std::thread> workers;
+    pid_t owner_pid; // the process the workers belong to
+
+    // Everything below is protected by mutex
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+    const std::function<void (int)>* current_task = nullptr;
+    int task_count = 0;
+    int next_task = 0;
+    int finished_tasks = 0;
+    int batch_number = 0; // changes whenever a new batch is started
+    bool stopping = false;
+    std::exception_ptr first_exception;
+
+    // Wait for batches and help run them until the pool is destroyed
+    void worker_loop();
+
+    // Take tasks from the current batch until there are none left. lock must
+    // hold mutex, it is released while each task runs.
+    void run_tasks(std::unique_lock<std::mutex>& lock);
+};
+
+#endif
@@ -3,6 +3,8 @@
 
 #include "Warship.h"
 
+#include <vector>
+
 /* A Torpedo_boat is a short range warship that can follow a boat while it is attacking,
  * and will take evasive action if it is attacked by retreating to a nearby island.
  * The island we will retreat to is the closest island to the attacker that is at
@@ -12,13 +14,25 @@
 class Torpedo_boat : public Warship {
 public:
     // Construct a torpedo boat
-    Torpedo_boat(const std::string& name_, Point position_);
+    Torpedo_boat(const std::string& name_, Point position_,
+            const Ship_parameters* parameters_);
 
     // Add the ship type to the description
     void describe() const override;
 
+    // Bytes used by the torpedo boat
+    std::size_t get_memory_size() const override
+        { return sizeof(Torpedo_boat) + Ship::get_memory_size(); }
+
     // If we are hit, take evasive action
-    void receive_hit(int hit_force, std::shared_ptr<Ship_component> attacker_ptr) override;
+    void react_to_hit(std::shared_ptr<Ship_component> attacker_ptr) override;
+
+    // Return the island to retreat to from an attacker at attacker_position, out
+    // of islands, which must not be empty and be sorted by name. This is the
+    // closest island that is far enough from the attacker, or the farthest island
+    // if none are.
+    static std::shared_ptr<Island> choose_retreat_island(
+            const std::vector<std::shared_ptr<Island>>& islands, Point attacker_position);
 protected:
     // If we are out of range of our target, move to the target's location so
     // we can attack it when we get in range
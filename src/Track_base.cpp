@@ -3,17 +3,19 @@
 
 #include <iostream>
 #include <cmath>
+#include <limits>
 
 using namespace std;
 
 /* Public Function Definitions */
 
-Track_base::Track_base() : altitude(0.) { }
+Track_base::Track_base() { }
 
-Track_base::Track_base(Point position_) : position(position_), altitude(0.) { }
+Track_base::Track_base(Point position_) : position(position_) { }
 
-Track_base::Track_base(Point position_, Course_speed course_speed_, double altitude_) :
-		position(position_), course_speed(course_speed_), altitude(altitude_) { }
+Track_base::Track_base(Point position_, Course_speed course_speed_) :
+		position(position_), course_speed(course_speed_),
+		velocity(to_Cartesian_vector(course_speed_)) { }
 
 
 // range and bearing of this track from a specified position
@@ -32,11 +34,16 @@ Compass_position Track_base::get_range_and_bearing_from (const Track_base * trac
 
 // range and bearing of closet point of approach from a specified track
 // the other track is "ownship" normally, so this appears to be "backwards"
+// Both tracks already have their velocities, so the CPA is computed in cartesian form.
 Compass_position Track_base::get_CPA_range_and_bearing_from(const Track_base *track_ptr) const
 {
+	Cartesian_vector relative_position = position - track_ptr->position;
+	Cartesian_vector relative_velocity = velocity - track_ptr->velocity;
+	Compass_position result;
 	double time_until_CPA;
-	Compass_position result = 
-		compute_CPA(track_ptr->get_course_speed(), course_speed, get_range_and_bearing_from(track_ptr), time_until_CPA);
+	compute_CPAs(1, &relative_position.delta_x, &relative_position.delta_y,
+		&relative_velocity.delta_x, &relative_velocity.delta_y,
+		numeric_limits<double>::infinity(), &result.range, &result.bearing, &time_until_CPA);
 	return result;
 }
 
@@ -63,6 +70,6 @@ bool Track_base::is_inbound_toward(const Track_base * track_ptr) const
 // update the position of this object
 void Track_base::update_position(double time_increment)
 {
-	position = position + (course_speed * time_increment);
+	position = position + velocity * time_increment;
 }
 
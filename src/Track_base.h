@@ -1,8 +1,9 @@
 /*
 The Track_base class defines a base class of track objects, which are objects that move
-according to course and speed. They have a Point, a Course_speed, and an altitude 
-(set to zero for surface tracks). When updated, they change their Point 
-as a function of their Course_speed.
+according to course and speed. They have a Point and a Course_speed; all tracks
+in this simulation are on the surface, so no altitude is kept. When updated, they change their Point 
+as a function of their Course_speed. The Course_speed is kept as a velocity as well,
+so that moving the track doesn't need to convert compass degrees each time.
 
 Various values can be calculated for this track's position or motion as viewed from
 some other track.
@@ -19,7 +20,7 @@ public:
 	// Constructors
 	Track_base();
 	Track_base(Point position_);
-	Track_base(Point position_, Course_speed course_speed_, double altitude_ = 0.);
+	Track_base(Point position_, Course_speed course_speed_);
 
 	// Readers
 	Point get_position() const 
@@ -30,20 +31,19 @@ public:
 		{return course_speed.course;}
 	double get_speed() const 
 		{return course_speed.speed;}
-	double get_altitude() const
-		{return altitude;}
+	// the displacement from one hour of travel on the current course and speed
+	Cartesian_vector get_velocity() const
+		{return velocity;}
 			
 	// Writers
 	void set_position(Point position_)
 		{position = position_;}
 	void set_course_speed(const Course_speed& course_speed_)
-		{course_speed = course_speed_;}
+		{course_speed = course_speed_; velocity = to_Cartesian_vector(course_speed);}
 	void set_course (double course_)
-		{course_speed.course = course_;}
+		{course_speed.course = course_; velocity = to_Cartesian_vector(course_speed);}
 	void set_speed (double speed_)
-		{course_speed.speed = speed_;}
-	void set_altitude (double altitude_)
-		{altitude = altitude_;}
+		{course_speed.speed = speed_; velocity = to_Cartesian_vector(course_speed);}
 		
 	/* Calculate track motion analysis results from this track and a supplied 
 	other track or position - the other track is normally "ownship", so
@@ -63,13 +63,14 @@ public:
 	bool is_inbound_toward(const Track_base * track_ptr) const;
 	
 	// Update the position of this object using the supplied time increment
-	// which is multiplied by the speed to get the distance to be moved
-	virtual void update_position(double time_increment);
+	// which is multiplied by the speed to get the distance to be moved.
+	// Not virtual, so that a track is no bigger than its data.
+	void update_position(double time_increment);
 	
 private:
 	Point position;				// Current location
 	Course_speed course_speed;			// Current course & speed
-	double altitude;					// Current altitude
+	Cartesian_vector velocity;			// course_speed as a Cartesian_vector
 };
 
 #endif
@@ -1,7 +1,6 @@
 #include "Utility.h"
 
 #include "Island.h"
-#include "Navigation.h"
 
 using namespace std;
 
@@ -13,11 +12,12 @@ const size_t name_abbreviation_length_c = 2;
 // Construct a distance comparator object
 DistComp::DistComp(Point location) : common_loc(location) {}
 
-// Compare which object is closer to the common_location
+// Compare which object is closer to the common_location. Squared distances are in
+// the same order as the distances, so no square roots are needed.
 bool DistComp::operator() (const shared_ptr<Sim_object>& i1,
         const shared_ptr<Sim_object>& i2) {
-    double dist1 = Compass_vector(common_loc, i1->get_location()).distance;
-    double dist2 = Compass_vector(common_loc, i2->get_location()).distance;
+    double dist1 = cartesian_distance_squared(common_loc, i1->get_location());
+    double dist2 = cartesian_distance_squared(common_loc, i2->get_location());
     return dist1 < dist2;
 }
 
@@ -39,3 +39,10 @@ bool NameComp::operator() (const std::shared_ptr<Sim_object>& p1,
         const std::string& name2) {
     return p1->get_name() < name2;
 }
+
+/* Memory estimates */
+// An empty string has the capacity of the buffer inside the string, and a longer
+// string has its characters and a terminating null on the heap
+size_t get_string_memory_size(const string& str) {
+    return str.capacity() > string().capacity() ? str.capacity() + 1 : 0;
+}
@@ -3,6 +3,9 @@
 #include <exception>
 #include <memory>
 #include <type_traits>
+#include <streambuf>
+#include <string>
+#include <cstddef>
 
 #include "Geometry.h"
 
@@ -50,4 +53,36 @@ struct NameComp {
 			const std::string& name2);
 };
 
+/* Estimates of the heap memory used by standard containers, for reporting memory
+ * use. They count the memory of the container itself, but not memory owned by the
+ * elements, and assume the node layouts of the GNU library.
+ */
+
+// Bytes used by the nodes of a std::set or std::map: the element, the colour,
+// and the parent and two child links
+template <typename Container>
+std::size_t get_tree_memory_size(const Container& container)
+{
+    return container.size() *
+        (sizeof(typename Container::value_type) + 4 * sizeof(void*));
+}
+
+// Bytes used by the buckets and nodes of an unordered set or map: each node has
+// the element, the next link, and the cached hash
+template <typename Container>
+std::size_t get_hash_table_memory_size(const Container& container)
+{
+    return container.bucket_count() * sizeof(void*) + container.size() *
+        (sizeof(typename Container::value_type) + 2 * sizeof(void*));
+}
+
+// Bytes a string has allocated, none if it fits in the string itself
+std::size_t get_string_memory_size(const std::string& str);
+
+// A stream buffer that discards everything written to it
+class Null_buffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
 #endif
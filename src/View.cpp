@@ -9,4 +9,6 @@ void View::update_location(const std::string&, Point) { }
 void View::update_course(const std::string&, double) { }
 void View::update_speed(const std::string&, double) { }
 void View::update_fuel(const std::string&, double) { }
+void View::update_group(const std::string&, const Group_summary&) { }
+void View::update_time(int) { }
 void View::update_remove(const std::string&) { }
\ No newline at end of file
@@ -13,6 +13,8 @@
 
 #include "Geometry.h"
 
+struct Group_summary;
+
 class View {
 public:
     // Virtual destructor to make sure right destructors are called.
@@ -30,6 +32,13 @@ public:
     // Update the fuel of an object in the view.
     virtual void update_fuel(const std::string& name, double fuel);
 
+    // Update the summary of a group's ships in the view.
+    virtual void update_group(const std::string& name, const Group_summary& summary);
+
+    // Called at the end of each update of the simulation, once every object has
+    // updated and sent its changes, with the new time.
+    virtual void update_time(int time);
+
 	// Remove an object's data from a view; no error if the object is not in the view
 	virtual void update_remove(const std::string& name);
 	
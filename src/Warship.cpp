@@ -2,6 +2,7 @@
 
 #include "Utility.h"
 #include "Model.h"
+#include "Snapshot.h"
 
 #include <iostream>
 #include <cassert>
@@ -9,19 +10,19 @@
 
 using namespace std;
 
+vector<Warship::Fire_event> Warship::fire_events;
+
 /* Warships are ships that can attack other ships. The file contains three classes:
  * Warship, Cruiser, and Torpedo_boat.
  */
 
 // Construct a warshipo
-Warship::Warship(const std::string& name_, Point position_, double fuel_capacity_,
-        double maximum_speed, double fuel_consumption_, int resistance_, int firepower_,
-        double attack_range_) :
-            Ship(name_, position_, fuel_capacity_, maximum_speed, fuel_consumption_, resistance_),
-            firepower(firepower_), attack_range(attack_range_), attacking(false) { }
+Warship::Warship(const std::string& name_, Point position_,
+        const Ship_parameters* parameters_) :
+            Ship(name_, position_, parameters_), attacking(false) { }
 
 // Uppdate the warship's state. If we are attacking a target, call receive_hit()
-// on the target so that it takes the hit.
+// on the target so that it takes the hit, or save the shot if combat is batched.
 void Warship::update() {
     Ship::update();
 
@@ -37,13 +38,18 @@ void Warship::update() {
     }
 
     cout << get_name() << " is attacking" << endl;
-    double dist_to_target =
-            cartesian_distance(get_location(), target_ptr->get_location());
+    double dist_squared_to_target =
+            cartesian_distance_squared(get_location(), target_ptr->get_location());
 
     // If the target is in range, attack it, if not call the out of range handler function
-    if (dist_to_target <= attack_range) {
-        cout << get_name() << " fires" << endl;
-        target_ptr->receive_hit(firepower, shared_from_this());
+    double attack_range = get_parameters().attack_range;
+    if (dist_squared_to_target <= attack_range * attack_range) {
+        if (Model::get_inst()->is_combat_batched()) {
+            queue_fire(target_ptr);
+        } else {
+            cout << get_name() << " fires" << endl;
+            target_ptr->receive_hit(get_parameters().firepower, shared_from_this());
+        }
     } else {
         target_out_of_range_handler();
     }
@@ -88,3 +94,66 @@ void Warship::stop_attack() {
     cout << get_name() << " stopping attack" << endl;
 }
 
+// Save the attack state. A target that is gone is written as no ship, so the
+// warship is restored still attacking but with no target: describe() reports
+// attacking an absent ship and the next update stops the attack, as it would
+// have without the save.
+void Warship::save_state(Snapshot_writer& writer) const {
+    Ship::save_state(writer);
+    writer.write_bool(attacking);
+    writer.write_ship(target.lock());
+}
+
+// Restore the attack state
+void Warship::restore_state(Snapshot_reader& reader) {
+    Ship::restore_state(reader);
+    attacking = reader.read_bool();
+    target = dynamic_pointer_cast<Ship>(reader.read_ship());
+}
+
+/* Private member functions */
+
+// The first shot of an update schedules the combat phase
+void Warship::queue_fire(shared_ptr<Ship> target_ptr) {
+    if (fire_events.empty())
+        Model::get_inst()->schedule_update_phase(&Warship::resolve_combat);
+    fire_events.push_back({static_pointer_cast<Warship>(shared_from_this()), target_ptr});
+}
+
+// The shots are grouped by target, keeping the order they were fired in for each
+// target, and each step is done for every target before the next step starts.
+// A ship that sinks in this update still gets its shots in, since it fired before
+// it sank.
+void Warship::resolve_combat() {
+    vector<Fire_event> events;
+    events.swap(fire_events);
+    stable_sort(events.begin(), events.end(), [](const Fire_event& lhs, const Fire_event& rhs) {
+        return lhs.target->get_name() < rhs.target->get_name();
+    });
+
+    for (auto& event : events) {
+        cout << event.attacker->get_name() << " fires" << endl;
+        event.target->take_hit(event.attacker->get_parameters().firepower);
+    }
+
+    // Each target's shots are from first to last
+    vector<pair<size_t, size_t>> targets;
+    for (size_t first = 0, last; first < events.size(); first = last) {
+        for (last = first + 1; last < events.size() &&
+                events[last].target == events[first].target; ++last);
+        targets.emplace_back(first, last);
+    }
+
+    for (auto& target : targets)
+        events[target.first].target->check_sinking();
+
+    for (auto& target : targets) {
+        shared_ptr<Ship> target_ptr = events[target.first].target;
+        if (!target_ptr->is_afloat())
+            continue;
+        auto attacker_it = find_if(events.begin() + target.first, events.begin() + target.second,
+                [](const Fire_event& event) { return event.attacker->is_afloat(); });
+        if (attacker_it != events.begin() + target.second)
+            target_ptr->react_to_hit(attacker_it->attacker);
+    }
+}
@@ -3,14 +3,25 @@
 
 #include "Ship.h"
 
+#include <vector>
+
 /* A warship has the ability to attack other ships, so it overrides the required
+ *
+ * Normally a warship's hit lands as soon as it fires, during its own update, so the
+ * target can sink, counter attack, or retreat before the ships after it in the
+ * Model have updated. When the Model's combat is batched, warships only record
+ * that they fired, and all of the hits of the update are resolved together once
+ * every object has updated: first every hit lands, then every ship that was hit
+ * and is out of resistance sinks, and then every surviving ship that was hit
+ * reacts to the first of its attackers that is still afloat. Hits are resolved
+ * target by target, in name order.
  */
+
 class Warship : public Ship {
 public:
     // initialize a warship
-    Warship(const std::string& name_, Point position_, double fuel_capacity_,
-            double maximum_speed, double fuel_consumption_, int resistance_, int firepower_,
-            double attack_range_);
+    Warship(const std::string& name_, Point position_,
+            const Ship_parameters* parameters_);
 
     // Attack the target if we are attacking during the update.
     // Calls target_out_of_range_handler() if the target is out of range
@@ -24,6 +35,11 @@ public:
 
     // Stop attacking
     void stop_attack() override;
+
+    // Save and restore the attack state along with the Ship state. The firepower
+    // and attack range are saved with the Ship's parameters.
+    void save_state(Snapshot_writer& writer) const override;
+    void restore_state(Snapshot_reader& reader) override;
 protected:
     // Derived classes must decide what to do if the target is out of range durring
     // an attack
@@ -35,8 +51,21 @@ protected:
     // Return the target of our attack
     std::shared_ptr<Ship_component> get_attack_target() const {return target.lock();};
 private:
-    int firepower;          // Firepower of the curiser
-    double attack_range;  // Attack range of the cruiser
+    // A shot fired during the update, resolved at the end of it
+    struct Fire_event {
+        std::shared_ptr<Warship> attacker;
+        std::shared_ptr<Ship> target;
+    };
+    // The shots waiting to be resolved, in the order they were fired
+    static std::vector<Fire_event> fire_events;
+
+    // Record a shot at target_ptr, and have the Model resolve the shots at the end
+    // of the update if this is the first one
+    void queue_fire(std::shared_ptr<Ship> target_ptr);
+
+    // Resolve all of the shots fired during the update
+    static void resolve_combat();
+
     bool attacking;
     std::weak_ptr<Ship> target;     // Target to attack
 };
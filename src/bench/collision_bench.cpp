@@ -0,0 +1,149 @@
+/* Collision screening benchmark
+ *
+ * Measures the time Collision_view takes to screen a large fleet each tick. The
+ * ships are spread at random over a square ocean, on random courses and speeds,
+ * and are moved between ticks like the Model would move them. A smaller fleet is
+ * first screened by the view and by checking every pair, to make sure that the
+ * broad phase doesn't lose any pairs.
+ *
+ * Usage: collision_bench [number_of_ships] [number_of_ticks]
+ */
+
+#include "Collision_view.h"
+#include "Navigation.h"
+#include "Utility.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace std::chrono;
+
+const int default_ship_count_c = 100000;
+const int default_tick_count_c = 20;
+const int check_ship_count_c = 3000;
+// About one ship in every 400 square nm
+const double ocean_area_per_ship_c = 400.;
+const double warning_range_c = 1.;
+const double horizon_c = 1.;
+
+struct Bench_ship {
+    string name;
+    Point position;
+    double course;
+    double speed;
+};
+
+static vector<Bench_ship> make_fleet(int ship_count);
+static Cartesian_vector velocity_of(const Bench_ship& ship);
+static int count_pairs_in_danger(const vector<Bench_ship>& fleet);
+static double seconds_since(steady_clock::time_point start);
+
+int main(int argc, char* argv[]) {
+    int ship_count = argc > 1 ? stoi(argv[1]) : default_ship_count_c;
+    int tick_count = argc > 2 ? stoi(argv[2]) : default_tick_count_c;
+    cout.setf(ios::fixed, ios::floatfield);
+    cout.precision(2);
+
+    // Check the view against every pair of a smaller fleet
+    {
+        vector<Bench_ship> fleet = make_fleet(check_ship_count_c);
+        Collision_view view(warning_range_c, horizon_c);
+        for (const Bench_ship& ship : fleet) {
+            view.update_location(ship.name, ship.position);
+            view.update_course(ship.name, ship.course);
+            view.update_speed(ship.name, ship.speed);
+        }
+        int view_count = view.screen_ships();
+        int pair_count = count_pairs_in_danger(fleet);
+        cout << "Check with " << check_ship_count_c << " ships: " << view_count <<
+                " pairs found, " << pair_count << " pairs in danger" << endl;
+        if (view_count != pair_count) {
+            cout << "Pairs were lost!" << endl;
+            return 1;
+        }
+    }
+
+    vector<Bench_ship> fleet = make_fleet(ship_count);
+    Collision_view view(warning_range_c, horizon_c);
+    for (const Bench_ship& ship : fleet) {
+        view.update_location(ship.name, ship.position);
+        view.update_course(ship.name, ship.course);
+        view.update_speed(ship.name, ship.speed);
+    }
+
+    double screen_seconds = 0.;
+    long long warning_total = 0;
+    for (int tick = 0; tick < tick_count; ++tick) {
+        for (Bench_ship& ship : fleet) {
+            ship.position = ship.position + velocity_of(ship);
+            view.update_location(ship.name, ship.position);
+        }
+        auto start = steady_clock::now();
+        warning_total += view.screen_ships();
+        screen_seconds += seconds_since(start);
+    }
+    cout << ship_count << " ships, " << tick_count << " ticks: " <<
+            screen_seconds / tick_count * 1000. << " ms/tick, " <<
+            static_cast<double>(warning_total) / tick_count << " warnings/tick" << endl;
+    return 0;
+}
+
+// Random positions, courses, and speeds from 0 to 30 knots, with one ship in ten
+// stopped
+static vector<Bench_ship> make_fleet(int ship_count) {
+    mt19937 generator(1);
+    double ocean_size = sqrt(ship_count * ocean_area_per_ship_c);
+    uniform_real_distribution<double> coordinate(0., ocean_size);
+    uniform_real_distribution<double> heading(0., 359.);
+    uniform_real_distribution<double> speed(0., 30.);
+    vector<Bench_ship> fleet;
+    for (int i = 0; i < ship_count; ++i) {
+        Bench_ship ship = {"ship" + to_string(i), Point(coordinate(generator),
+                coordinate(generator)), heading(generator), speed(generator)};
+        if (i % 10 == 0)
+            ship.speed = 0.;
+        fleet.push_back(ship);
+    }
+    return fleet;
+}
+
+static Cartesian_vector velocity_of(const Bench_ship& ship) {
+    return to_Cartesian_vector(Course_speed(ship.course, ship.speed));
+}
+
+// Check every pair of ships that are not both stopped for a closest approach
+// within the horizon that is nearer than the warning range
+static int count_pairs_in_danger(const vector<Bench_ship>& fleet) {
+    int count = 0;
+    for (size_t i = 0; i < fleet.size(); ++i) {
+        Cartesian_vector first_velocity = velocity_of(fleet[i]);
+        for (size_t j = i + 1; j < fleet.size(); ++j) {
+            if (fleet[i].speed == 0. && fleet[j].speed == 0.)
+                continue;
+            Cartesian_vector second_velocity = velocity_of(fleet[j]);
+            double dx = fleet[j].position.x - fleet[i].position.x;
+            double dy = fleet[j].position.y - fleet[i].position.y;
+            double dvx = second_velocity.delta_x - first_velocity.delta_x;
+            double dvy = second_velocity.delta_y - first_velocity.delta_y;
+            double speed_square = dvx * dvx + dvy * dvy;
+            double t = speed_square > 0. ? -(dx * dvx + dy * dvy) / speed_square : 0.;
+            t = min(max(t, 0.), horizon_c);
+            double cpa_x = dx + dvx * t;
+            double cpa_y = dy + dvy * t;
+            if (sqrt(cpa_x * cpa_x + cpa_y * cpa_y) < warning_range_c)
+                ++count;
+        }
+    }
+    return count;
+}
+
+// Return the time in seconds since start
+static double seconds_since(steady_clock::time_point start) {
+    return duration<double>(steady_clock::now() - start).count();
+}
@@ -0,0 +1,152 @@
+/* Command parsing benchmark
+ *
+ * Measures how fast scripted commands are read, first the tokenizing alone with
+ * istream extraction and with Command_reader, then whole commands run through the
+ * Controller with their output discarded.
+ *
+ * Usage: command_bench [number_of_commands]
+ */
+
+#include "Controller.h"
+#include "Command_reader.h"
+#include "Utility.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <random>
+
+using namespace std;
+using namespace std::chrono;
+
+const int default_command_count_c = 300000;
+const int ship_count_c = 500;
+const int commands_per_go_c = 10000;
+
+// The kind of value each word of a command is read as
+enum class Token_t {WORD, DOUBLE};
+
+static string make_script(int command_count, vector<Token_t>& tokens);
+static double seconds_since(steady_clock::time_point start);
+
+int main(int argc, char* argv[]) {
+    int command_count = argc > 1 ? stoi(argv[1]) : default_command_count_c;
+    vector<Token_t> tokens;
+    string script = make_script(command_count, tokens);
+    cout << "Script of " << command_count << " commands, " << tokens.size() <<
+            " tokens, " << script.size() / 1024 << " KB" << endl;
+
+    // Tokenize with istream extraction, the way the commands used to be read
+    {
+        auto start = steady_clock::now();
+        istringstream is(script);
+        string word;
+        double d;
+        for (Token_t token : tokens) {
+            if (token == Token_t::WORD)
+                is >> word;
+            else
+                is >> d;
+        }
+        double seconds = seconds_since(start);
+        cout << "istream extraction: " << tokens.size() / seconds / 1e6 <<
+                " M tokens/s" << endl;
+    }
+
+    // Tokenize the same text with Command_reader
+    {
+        auto start = steady_clock::now();
+        Command_reader reader(script);
+        string word;
+        double d;
+        for (Token_t token : tokens) {
+            if (token == Token_t::WORD)
+                reader.read_word(word);
+            else
+                reader.read_double(d);
+        }
+        double seconds = seconds_since(start);
+        cout << "Command_reader:     " << tokens.size() / seconds / 1e6 <<
+                " M tokens/s" << endl;
+    }
+
+    // Run the whole script through the Controller
+    {
+        istringstream script_stream(script + "quit\n");
+        cin.rdbuf(script_stream.rdbuf());
+        Null_buffer null_buffer;
+        streambuf* output_buffer = cout.rdbuf(&null_buffer);
+        auto start = steady_clock::now();
+        Controller controller;
+        controller.run();
+        double seconds = seconds_since(start);
+        cout.rdbuf(output_buffer);
+        cout << "Controller:         " << command_count / seconds <<
+                " commands/s" << endl;
+    }
+    return 0;
+}
+
+// Create ships with two letter names, then give them random orders, with a "go"
+// every so often. Record the kind of every token for the tokenizer runs.
+static string make_script(int command_count, vector<Token_t>& tokens) {
+    const string letters = "bcdfghjklmnpqrstvwz";
+    const vector<string> islands = {"Exxon", "Shell", "Bermuda", "Treasure_Island"};
+    mt19937 generator(1);
+    uniform_real_distribution<double> coordinate(-50., 50.);
+    uniform_real_distribution<double> heading(0., 359.);
+    uniform_real_distribution<double> speed(1., 10.);
+
+    ostringstream script;
+    vector<string> ship_names;
+    for (int i = 0; i < ship_count_c; ++i) {
+        string name = {letters[i / letters.size() % letters.size()],
+                letters[i % letters.size()], 'x', 'y'};
+        ship_names.push_back(name);
+        script << "create " << name << " Cruiser " << coordinate(generator) << ' ' <<
+                coordinate(generator) << '\n';
+        tokens.insert(tokens.end(), {Token_t::WORD, Token_t::WORD, Token_t::WORD,
+                Token_t::DOUBLE, Token_t::DOUBLE});
+    }
+
+    for (int i = ship_count_c; i < command_count; ++i) {
+        if (i % commands_per_go_c == 0) {
+            script << "go\n";
+            tokens.push_back(Token_t::WORD);
+            continue;
+        }
+        const string& ship_name = ship_names[generator() % ship_names.size()];
+        script << ship_name;
+        switch (generator() % 4) {
+            case 0:
+                script << " course " << heading(generator) << ' ' << speed(generator);
+                tokens.insert(tokens.end(), {Token_t::WORD, Token_t::WORD,
+                        Token_t::DOUBLE, Token_t::DOUBLE});
+                break;
+            case 1:
+                script << " position " << coordinate(generator) << ' ' <<
+                        coordinate(generator) << ' ' << speed(generator);
+                tokens.insert(tokens.end(), {Token_t::WORD, Token_t::WORD,
+                        Token_t::DOUBLE, Token_t::DOUBLE, Token_t::DOUBLE});
+                break;
+            case 2:
+                script << " destination " << islands[generator() % islands.size()] <<
+                        ' ' << speed(generator);
+                tokens.insert(tokens.end(), {Token_t::WORD, Token_t::WORD,
+                        Token_t::WORD, Token_t::DOUBLE});
+                break;
+            default:
+                script << " stop";
+                tokens.insert(tokens.end(), {Token_t::WORD, Token_t::WORD});
+                break;
+        }
+        script << '\n';
+    }
+    return script.str();
+}
+
+// Return the time in seconds since start
+static double seconds_since(steady_clock::time_point start) {
+    return duration<double>(steady_clock::now() - start).count();
+}
@@ -0,0 +1,107 @@
+/* CPA benchmark
+ *
+ * Computes the CPAs of random ownship/target pairs one at a time with compute_CPA
+ * and all together with compute_CPAs, reports how fast each is, and checks that
+ * they give the same ranges, bearings, and times.
+ *
+ * Usage: cpa_bench [number_of_pairs]
+ */
+
+#include "Navigation.h"
+#include "Geometry.h"
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace std::chrono;
+
+const int default_pair_count_c = 1000000;
+const double tolerance_c = 1e-6;
+
+static double seconds_since(steady_clock::time_point start);
+
+int main(int argc, char* argv[]) {
+    int pair_count = argc > 1 ? stoi(argv[1]) : default_pair_count_c;
+    cout.setf(ios::fixed, ios::floatfield);
+    cout.precision(2);
+
+    mt19937 generator(1);
+    uniform_real_distribution<double> heading(0., 359.99);
+    uniform_real_distribution<double> speed(0., 30.);
+    uniform_real_distribution<double> range(0.1, 100.);
+    vector<Course_speed> ownship_cs(pair_count), target_cs(pair_count);
+    vector<Compass_position> target_cp(pair_count);
+    for (int i = 0; i < pair_count; ++i) {
+        ownship_cs[i] = Course_speed(heading(generator), speed(generator));
+        target_cs[i] = Course_speed(heading(generator), speed(generator));
+        target_cp[i] = Compass_position(heading(generator), range(generator));
+    }
+
+    // One pair at a time
+    vector<Compass_position> scalar_cpa(pair_count);
+    vector<double> scalar_time(pair_count);
+    auto start = steady_clock::now();
+    for (int i = 0; i < pair_count; ++i)
+        scalar_cpa[i] = compute_CPA(ownship_cs[i], target_cs[i], target_cp[i], scalar_time[i]);
+    double scalar_seconds = seconds_since(start);
+
+    // The same pairs in cartesian form, all at once
+    vector<double> relative_x(pair_count), relative_y(pair_count),
+            relative_x_velocity(pair_count), relative_y_velocity(pair_count);
+    for (int i = 0; i < pair_count; ++i) {
+        Point target = Point() + target_cp[i];
+        Cartesian_vector velocity =
+                to_Cartesian_vector(target_cs[i]) - to_Cartesian_vector(ownship_cs[i]);
+        relative_x[i] = target.x;
+        relative_y[i] = target.y;
+        relative_x_velocity[i] = velocity.delta_x;
+        relative_y_velocity[i] = velocity.delta_y;
+    }
+    vector<double> ranges(pair_count), bearings(pair_count), times(pair_count);
+    start = steady_clock::now();
+    compute_CPAs(pair_count, relative_x.data(), relative_y.data(), relative_x_velocity.data(),
+            relative_y_velocity.data(), numeric_limits<double>::infinity(),
+            ranges.data(), bearings.data(), times.data());
+    double batch_seconds = seconds_since(start);
+    start = steady_clock::now();
+    compute_CPAs(pair_count, relative_x.data(), relative_y.data(), relative_x_velocity.data(),
+            relative_y_velocity.data(), numeric_limits<double>::infinity(),
+            ranges.data(), nullptr, times.data());
+    double no_bearing_seconds = seconds_since(start);
+
+    double range_error = 0., bearing_error = 0., time_error = 0.;
+    for (int i = 0; i < pair_count; ++i) {
+        range_error = max(range_error, fabs(ranges[i] - scalar_cpa[i].range));
+        time_error = max(time_error, fabs(times[i] - scalar_time[i]));
+        // Bearings just either side of north are close together
+        double bearing_difference = fabs(bearings[i] - scalar_cpa[i].bearing);
+        bearing_error = max(bearing_error, min(bearing_difference, 360. - bearing_difference));
+    }
+
+    cout << pair_count << " pairs" << endl;
+    cout << "compute_CPA:                  " << pair_count / scalar_seconds / 1e6 <<
+            " M pairs/s" << endl;
+    cout << "compute_CPAs:                 " << pair_count / batch_seconds / 1e6 <<
+            " M pairs/s" << endl;
+    cout << "compute_CPAs without bearing: " << pair_count / no_bearing_seconds / 1e6 <<
+            " M pairs/s" << endl;
+    cout.precision(10);
+    cout << "Largest differences: range " << range_error << " nm, bearing " <<
+            bearing_error << " deg, time " << time_error << " hr" << endl;
+    if (range_error > tolerance_c || bearing_error > tolerance_c || time_error > tolerance_c) {
+        cout << "Results differ!" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Return the time in seconds since start
+static double seconds_since(steady_clock::time_point start) {
+    return duration<double>(steady_clock::now() - start).count();
+}
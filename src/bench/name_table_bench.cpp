@@ -0,0 +1,120 @@
+/* Object storage benchmark
+ *
+ * Compares the Name_table that the Model keeps its objects in with the std::map
+ * it used to use, for a large number of objects: adding them in random order,
+ * going through all of them in name order as an update does, and looking them up
+ * by name. Both containers must go through the objects in the same order.
+ *
+ * Usage: name_table_bench [number_of_objects] [number_of_passes]
+ */
+
+#include "Name_table.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+using namespace std;
+using namespace std::chrono;
+
+const int default_object_count_c = 100000;
+const int default_pass_count_c = 100;
+
+// Stands in for a Sim_object, with a virtual update that does a little work
+class Bench_object {
+public:
+    Bench_object(const string& name_) : name(name_) { }
+    virtual ~Bench_object() = default;
+    const string& get_name() const { return name; }
+    virtual void update() { ++update_count; }
+    long long get_update_count() const { return update_count; }
+private:
+    string name;
+    long long update_count = 0;
+};
+
+static double seconds_since(steady_clock::time_point start);
+
+int main(int argc, char* argv[]) {
+    int object_count = argc > 1 ? stoi(argv[1]) : default_object_count_c;
+    int pass_count = argc > 2 ? stoi(argv[2]) : default_pass_count_c;
+    cout.setf(ios::fixed, ios::floatfield);
+    cout.precision(2);
+
+    mt19937 generator(1);
+    vector<shared_ptr<Bench_object>> new_objects;
+    for (int i = 0; i < object_count; ++i)
+        new_objects.push_back(make_shared<Bench_object>("ship" + to_string(i)));
+    shuffle(new_objects.begin(), new_objects.end(), generator);
+    vector<string> lookups;
+    for (auto& object_ptr : new_objects)
+        lookups.push_back(object_ptr->get_name());
+    shuffle(lookups.begin(), lookups.end(), generator);
+
+    map<string, shared_ptr<Bench_object>> object_map;
+    Name_table<Bench_object> object_table;
+
+    auto start = steady_clock::now();
+    for (auto& object_ptr : new_objects)
+        object_map.insert({object_ptr->get_name(), object_ptr});
+    double map_insert_seconds = seconds_since(start);
+    start = steady_clock::now();
+    for (auto& object_ptr : new_objects)
+        object_table.insert(object_ptr);
+    object_table.get_entries();
+    double table_insert_seconds = seconds_since(start);
+
+    auto map_it = object_map.begin();
+    for (auto& entry : object_table.get_entries()) {
+        if (map_it == object_map.end() || map_it->second != entry.second) {
+            cout << "The objects are in a different order!" << endl;
+            return 1;
+        }
+        ++map_it;
+    }
+
+    start = steady_clock::now();
+    for (int pass = 0; pass < pass_count; ++pass) {
+        for (auto& object_pair : object_map)
+            object_pair.second->update();
+    }
+    double map_pass_seconds = seconds_since(start);
+    start = steady_clock::now();
+    for (int pass = 0; pass < pass_count; ++pass) {
+        for (auto& entry : object_table.get_entries()) {
+            if (entry.second)
+                entry.second->update();
+        }
+    }
+    double table_pass_seconds = seconds_since(start);
+
+    long long found = 0;
+    start = steady_clock::now();
+    for (auto& name : lookups)
+        found += object_map.find(name) != object_map.end();
+    double map_find_seconds = seconds_since(start);
+    start = steady_clock::now();
+    for (auto& name : lookups)
+        found += object_table.find(name) != nullptr;
+    double table_find_seconds = seconds_since(start);
+
+    cout << object_count << " objects, " << found / 2 << " found" << endl;
+    cout << "            insert (ms)   pass (ms)   find (ms)" << endl;
+    cout << "std::map    " << map_insert_seconds * 1000. << "   " <<
+            map_pass_seconds / pass_count * 1000. << "   " <<
+            map_find_seconds * 1000. << endl;
+    cout << "Name_table  " << table_insert_seconds * 1000. << "   " <<
+            table_pass_seconds / pass_count * 1000. << "   " <<
+            table_find_seconds * 1000. << endl;
+    return 0;
+}
+
+// Return the time in seconds since start
+static double seconds_since(steady_clock::time_point start) {
+    return duration<double>(steady_clock::now() - start).count();
+}
@@ -0,0 +1,104 @@
+/* Torpedo_boat retreat benchmark
+ *
+ * Measures how fast a Torpedo_boat chooses the island to retreat to from a large
+ * number of islands. The way it used to be chosen, by sorting the islands by
+ * distance from the attacker, is timed alongside for comparison, and both must
+ * choose the same island for every attacker position.
+ *
+ * Usage: retreat_bench [number_of_islands] [number_of_retreats]
+ */
+
+#include "Torpedo_boat.h"
+#include "Island.h"
+#include "Navigation.h"
+#include "Utility.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+using namespace std;
+using namespace std::chrono;
+
+const int default_island_count_c = 10000;
+const int default_retreat_count_c = 200;
+const double retreat_dist_c = 15.;
+
+static shared_ptr<Island> sort_retreat_island(vector<shared_ptr<Island>> islands,
+        Point attacker_position);
+static double seconds_since(steady_clock::time_point start);
+
+int main(int argc, char* argv[]) {
+    int island_count = argc > 1 ? stoi(argv[1]) : default_island_count_c;
+    int retreat_count = argc > 2 ? stoi(argv[2]) : default_retreat_count_c;
+    cout.setf(ios::fixed, ios::floatfield);
+    cout.precision(2);
+
+    // Islands on a grid of whole nm, so that many are the same distance from an
+    // attacker and ties have to be broken by name
+    mt19937 generator(1);
+    uniform_int_distribution<int> coordinate(0, 1000);
+    Island_fuel_table fuel_table;
+    vector<shared_ptr<Island>> islands;
+    for (int i = 0; i < island_count; ++i)
+        islands.push_back(make_shared<Island>("Island" + to_string(i),
+                Point(coordinate(generator), coordinate(generator)), fuel_table));
+    sort(islands.begin(), islands.end(), NameComp());
+
+    vector<Point> attackers;
+    for (int i = 0; i < retreat_count; ++i)
+        attackers.push_back(Point(coordinate(generator), coordinate(generator)));
+    // An attacker far from every island, where the farthest island is chosen
+    attackers.push_back(Point(-1e6, -1e6));
+
+    vector<shared_ptr<Island>> sorted_choices;
+    auto start = steady_clock::now();
+    for (Point attacker : attackers)
+        sorted_choices.push_back(sort_retreat_island(islands, attacker));
+    double sort_seconds = seconds_since(start);
+
+    vector<shared_ptr<Island>> choices;
+    start = steady_clock::now();
+    for (Point attacker : attackers)
+        choices.push_back(Torpedo_boat::choose_retreat_island(islands, attacker));
+    double choose_seconds = seconds_since(start);
+
+    cout << island_count << " islands, " << attackers.size() << " retreats" << endl;
+    cout << "Sorting by distance:   " << sort_seconds / attackers.size() * 1000. <<
+            " ms/retreat" << endl;
+    cout << "choose_retreat_island: " << choose_seconds / attackers.size() * 1000. <<
+            " ms/retreat" << endl;
+    if (choices != sorted_choices) {
+        cout << "Different islands were chosen!" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// The island chosen by sorting all of the islands by distance from the attacker,
+// closest first, with each distance computed from a Compass_vector
+static shared_ptr<Island> sort_retreat_island(vector<shared_ptr<Island>> islands,
+        Point attacker_position) {
+    auto distance_less = [attacker_position](const shared_ptr<Island>& i1,
+            const shared_ptr<Island>& i2) {
+        return Compass_vector(attacker_position, i1->get_location()).distance <
+                Compass_vector(attacker_position, i2->get_location()).distance;
+    };
+    stable_sort(islands.begin(), islands.end(), distance_less);
+    auto dest_itt = find_if(islands.begin(), islands.end(),
+            [attacker_position](const shared_ptr<Island>& isl) {
+                return Compass_vector(attacker_position,
+                        isl->get_location()).distance >= retreat_dist_c;
+            });
+    if (dest_itt == islands.end())
+        dest_itt = max_element(islands.begin(), islands.end(), distance_less);
+    return *dest_itt;
+}
+
+// Return the time in seconds since start
+static double seconds_since(steady_clock::time_point start) {
+    return duration<double>(steady_clock::now() - start).count();
+}
@@ -0,0 +1,33 @@
+/*
+Ensemble main module. Runs every variant of the ensemble described by the spec
+file named on the command line, then prints a summary of the outcomes.
+See Ensemble.h for the format of the spec file.
+*/
+
+#include "Ensemble.h"
+#include "Utility.h"
+
+#include <iostream>
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	if (argc != 2) {
+		cout << "Usage: " << argv[0] << " <ensemble_spec_file>" << endl;
+		return 1;
+	}
+
+	// Set output to show two decimal places, the same as the simulation itself
+	cout.setf(ios::fixed, ios::floatfield);
+	cout.precision(2);
+
+	try {
+		Ensemble_runner runner(read_ensemble_spec(argv[1]));
+		runner.run();
+		runner.print_summary();
+	} catch (Error& e) {
+		cout << e.what() << endl;
+		return 1;
+	}
+}